@@ -0,0 +1,481 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+/**
+ * nac-abe-bench: throughput, latency and allocation figures for the ABE/AES engine
+ *
+ * Every case runs a warm-up iteration followed by measured iterations, and is
+ * reported as one JSON object:
+ *
+ *   {"name": "encrypt", "params": {"leaves": 16, "shape": "and"}, "iterations": 30,
+ *    "mean_ns": ..., "p50_ns": ..., "p99_ns": ..., "ops_per_sec": ...,
+ *    "bytes_per_sec": ..., "allocs_per_op": ...}
+ *
+ * Allocations are counted across operator new, pbc and GMP, which covers the group
+ * arithmetic; allocations made directly through malloc/glib are not seen.
+ */
+
+#include "algo/abe-support.hpp"
+#include "algo/cipher-text.hpp"
+#include "ndn-crypto/aes.hpp"
+#include "ndn-crypto/rsa.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+namespace {
+
+std::atomic<uint64_t> g_nAllocs(0);
+
+void*
+countingMalloc(size_t size)
+{
+  g_nAllocs++;
+  return std::malloc(size);
+}
+
+void*
+countingRealloc(void* ptr, size_t size)
+{
+  g_nAllocs++;
+  return std::realloc(ptr, size);
+}
+
+void*
+countingGmpRealloc(void* ptr, size_t, size_t size)
+{
+  return countingRealloc(ptr, size);
+}
+
+void
+gmpFree(void* ptr, size_t)
+{
+  std::free(ptr);
+}
+
+} // namespace
+
+void*
+operator new(std::size_t size)
+{
+  void* ptr = countingMalloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace ndn {
+namespace ndnabac {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+using Params = std::vector<std::pair<std::string, std::string>>;
+
+struct Options
+{
+  size_t nIterations = 30;
+  double maxSecondsPerCase = 2.0;
+  size_t maxPayload = 64 * 1024 * 1024;
+  std::string filter;
+};
+
+const std::vector<size_t> PAYLOAD_SIZES = {64, 1024, 16 * 1024, 256 * 1024,
+                                           4 * 1024 * 1024, 64 * 1024 * 1024};
+const std::vector<size_t> LEAF_COUNTS = {1, 2, 4, 8, 16, 32, 64};
+const std::vector<std::string> SHAPES = {"and", "or", "majority", "tree"};
+const std::vector<size_t> KEY_ATTRIBUTE_COUNTS = {1, 4, 16, 64};
+const size_t ABE_PAYLOAD = 1024;
+
+class Runner
+{
+public:
+  Runner(const Options& options, std::ostream& os)
+    : m_options(options)
+    , m_os(os)
+  {
+    m_os << "[";
+  }
+
+  ~Runner()
+  {
+    m_os << "\n]\n";
+  }
+
+  bool
+  isSelected(const std::string& name) const
+  {
+    return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+  }
+
+  /**
+   * @brief Measure @p op and print the result
+   * @param bytesPerOp payload processed by one call, 0 if not meaningful
+   */
+  void
+  run(const std::string& name, const Params& params, size_t bytesPerOp,
+      const std::function<void()>& op)
+  {
+    if (!isSelected(name)) {
+      return;
+    }
+
+    op(); // warm-up, also fills the process-wide caches
+
+    std::vector<double> latencies;
+    uint64_t nAllocs = 0;
+    auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(m_options.maxSecondsPerCase));
+    // at least 3 samples, so that very slow cases still report a distribution
+    while (latencies.size() < m_options.nIterations &&
+           (latencies.size() < 3 || Clock::now() < deadline)) {
+      uint64_t allocsBefore = g_nAllocs;
+      auto start = Clock::now();
+      op();
+      auto end = Clock::now();
+      nAllocs += g_nAllocs - allocsBefore;
+      latencies.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    report(name, params, bytesPerOp, latencies, nAllocs);
+  }
+
+private:
+  void
+  report(const std::string& name, const Params& params, size_t bytesPerOp,
+         std::vector<double>& latencies, uint64_t nAllocs)
+  {
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double l : latencies) {
+      total += l;
+    }
+    double mean = total / latencies.size();
+    auto percentile = [&latencies] (double p) {
+      // nearest rank
+      size_t rank = static_cast<size_t>(std::ceil(p * latencies.size()));
+      return latencies[std::max<size_t>(rank, 1) - 1];
+    };
+
+    m_os << (m_isFirst ? "\n" : ",\n");
+    m_isFirst = false;
+    m_os << "  {\"name\": \"" << name << "\", \"params\": {";
+    for (size_t i = 0; i < params.size(); i++) {
+      m_os << (i == 0 ? "" : ", ") << "\"" << params[i].first << "\": " << params[i].second;
+    }
+    m_os << "}, \"iterations\": " << latencies.size()
+         << ", \"mean_ns\": " << static_cast<uint64_t>(mean)
+         << ", \"p50_ns\": " << static_cast<uint64_t>(percentile(0.5))
+         << ", \"p99_ns\": " << static_cast<uint64_t>(percentile(0.99))
+         << ", \"ops_per_sec\": " << 1e9 / mean;
+    if (bytesPerOp > 0) {
+      m_os << ", \"bytes_per_sec\": " << bytesPerOp * 1e9 / mean;
+    }
+    m_os << ", \"allocs_per_op\": " << static_cast<double>(nAllocs) / latencies.size() << "}";
+    m_os.flush();
+  }
+
+private:
+  const Options& m_options;
+  std::ostream& m_os;
+  bool m_isFirst = true;
+};
+
+std::string
+quote(const std::string& str)
+{
+  return "\"" + str + "\"";
+}
+
+std::vector<std::string>
+makeAttributes(size_t count)
+{
+  std::vector<std::string> attrs;
+  for (size_t i = 0; i < count; i++) {
+    attrs.push_back("attr" + std::to_string(i));
+  }
+  return attrs;
+}
+
+/**
+ * @return a postfix policy over attr0..attr<nLeaves-1>, or an empty string if the shape
+ *         does not exist for @p nLeaves
+ */
+std::string
+makePolicy(const std::string& shape, size_t nLeaves)
+{
+  auto attrs = makeAttributes(nLeaves);
+  std::ostringstream os;
+  if (nLeaves == 1) {
+    if (shape != "and") {
+      return "";
+    }
+    os << attrs[0];
+    return os.str();
+  }
+
+  if (shape == "tree") {
+    // 2ofN gates over groups of up to four leaves, all of them required
+    if (nLeaves < 4) {
+      return "";
+    }
+    size_t nGroups = 0;
+    for (size_t i = 0; i < nLeaves; i += 4) {
+      size_t groupSize = std::min<size_t>(4, nLeaves - i);
+      for (size_t j = i; j < i + groupSize; j++) {
+        os << attrs[j] << " ";
+      }
+      if (groupSize > 1) {
+        os << "2of" << groupSize << " ";
+      }
+      nGroups++;
+    }
+    if (nGroups > 1) {
+      os << nGroups << "of" << nGroups;
+    }
+    return boost::algorithm::trim_copy(os.str());
+  }
+
+  size_t k = shape == "and" ? nLeaves : shape == "or" ? 1 : nLeaves / 2 + 1;
+  for (const auto& attr : attrs) {
+    os << attr << " ";
+  }
+  os << k << "of" << nLeaves;
+  return os.str();
+}
+
+void
+benchAbe(Runner& runner)
+{
+  runner.run("setup", {}, 0, [] {
+      algo::PublicParams pubParams;
+      algo::MasterKey masterKey;
+      algo::ABESupport::setup(pubParams, masterKey);
+    });
+
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  for (size_t nAttrs : KEY_ATTRIBUTE_COUNTS) {
+    auto attrs = makeAttributes(nAttrs);
+    runner.run("prvKeyGen", {{"attributes", std::to_string(nAttrs)}}, 0, [&] {
+        algo::ABESupport::prvKeyGen(pubParams, masterKey, attrs);
+      });
+  }
+
+  Buffer payload(ABE_PAYLOAD);
+  for (const auto& shape : SHAPES) {
+    for (size_t nLeaves : LEAF_COUNTS) {
+      auto policyString = makePolicy(shape, nLeaves);
+      if (policyString.empty()) {
+        continue;
+      }
+      Params params = {{"leaves", std::to_string(nLeaves)}, {"shape", quote(shape)},
+                       {"payload", std::to_string(payload.size())}};
+
+      runner.run("encrypt", params, payload.size(), [&] {
+          algo::ABESupport::encrypt(pubParams, policyString, payload);
+        });
+
+      algo::CompiledPolicy policy(policyString);
+      runner.run("encrypt-compiled", params, payload.size(), [&] {
+          algo::ABESupport::encrypt(pubParams, policy, payload);
+        });
+
+      if (!runner.isSelected("decrypt") && !runner.isSelected("decrypt-unprepared")) {
+        continue;
+      }
+      auto prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, makeAttributes(nLeaves));
+      algo::DecodedPrivateKey decodedKey(pubParams, prvKey);
+      auto cipherText = algo::ABESupport::encrypt(pubParams, policy, payload);
+      runner.run("decrypt", params, payload.size(), [&] {
+          algo::ABESupport::decrypt(decodedKey, cipherText);
+        });
+
+      // same key without pairing_pp_t tables, evaluated as one product of pairings
+      algo::DecodedPrivateKey unpreparedKey(pubParams, prvKey, false);
+      runner.run("decrypt-unprepared", params, payload.size(), [&] {
+          algo::ABESupport::decrypt(unpreparedKey, cipherText);
+        });
+    }
+  }
+}
+
+void
+benchSymmetric(Runner& runner, const Options& options)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  auto aesKey = Aes::generateKey(AesKeyParams());
+  auto iv = Aes::generateIV();
+
+  element_t m;
+  element_init_GT(m, pubParams.getPrepared()->pairing.get());
+  element_random(m);
+
+  for (size_t size : PAYLOAD_SIZES) {
+    if (size > options.maxPayload) {
+      continue;
+    }
+    Params params = {{"payload", std::to_string(size)}};
+    Buffer payload(size);
+
+    runner.run("aes_128_encrypt", params, size, [&] {
+        GByteArray pt{payload.data(), static_cast<guint>(payload.size())};
+        algo::ABESupport::aes_128_encrypt(&pt, m);
+      });
+
+    auto gcmKey = algo::ABESupport::deriveAes256Key(m);
+    runner.run("aes_256_gcm_encrypt", params, size, [&] {
+        algo::ABESupport::aes_256_gcm_encrypt(payload.data(), payload.size(), gcmKey);
+      });
+
+    algo::CipherText chunked;
+    chunked.m_suite = algo::CipherSuite::AES_256_GCM_CHUNKED;
+    chunked.m_chunkSize = algo::ABESupport::DEFAULT_CHUNK_SIZE;
+    auto chunkedKey = algo::ABESupport::deriveChunkedKey(m);
+    chunked.m_content = algo::ABESupport::aes_256_gcm_chunked_encrypt(payload.data(), payload.size(),
+                                                                      chunkedKey, chunked.m_chunkSize);
+    runner.run("aes_256_gcm_chunked_decrypt", params, size, [&] {
+        algo::ABESupport::aes_256_gcm_chunked_decrypt(chunked, chunkedKey, 0, chunked.getChunkCount());
+      });
+
+    runner.run("Aes::encrypt", params, size, [&] {
+        Aes::encrypt(aesKey.data(), aesKey.size(), payload.data(), payload.size(), iv);
+      });
+
+    if (!runner.isSelected("CipherText")) {
+      continue;
+    }
+    auto cipherText = algo::ABESupport::encrypt(pubParams, "attr0", payload);
+    runner.run("CipherText::wireEncode", params, size, [&] {
+        cipherText.wireEncode();
+      });
+
+    Block wire = cipherText.wireEncode();
+    runner.run("CipherText::wireDecode", params, size, [&] {
+        algo::CipherText decoded;
+        decoded.wireDecode(wire);
+      });
+  }
+  element_clear(m);
+
+  if (runner.isSelected("Rsa::encrypt")) {
+    RsaKeyParams rsaParams;
+    auto rsaKey = Rsa::deriveEncryptKey(Rsa::generateKey(rsaParams));
+    // RSA only ever wraps symmetric keys
+    for (size_t size : {16, 32, 64}) {
+      Buffer payload(size);
+      runner.run("Rsa::encrypt", {{"payload", std::to_string(size)}}, size, [&] {
+          Rsa::encrypt(rsaKey.data(), rsaKey.size(), payload.data(), payload.size());
+        });
+    }
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  Options options;
+  std::string outputFile;
+  po::options_description description("Usage: nac-abe-bench [options]\n\nOptions");
+  description.add_options()
+    ("help,h", "print this help message and exit")
+    ("filter,f", po::value<std::string>(&options.filter),
+     "only run cases whose name contains this string")
+    ("iterations,n", po::value<size_t>(&options.nIterations)->default_value(options.nIterations),
+     "measured iterations per case")
+    ("max-seconds,t", po::value<double>(&options.maxSecondsPerCase)->default_value(options.maxSecondsPerCase),
+     "stop a case after this many seconds (with at least 3 iterations)")
+    ("max-payload,p", po::value<size_t>(&options.maxPayload)->default_value(options.maxPayload),
+     "largest payload size to sweep, in bytes")
+    ("output,o", po::value<std::string>(&outputFile), "write JSON to this file instead of stdout")
+    ;
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, description), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n\n" << description << std::endl;
+    return 2;
+  }
+  if (vm.count("help") > 0) {
+    std::cout << description << std::endl;
+    return 0;
+  }
+
+  // count the allocations of the pairing arithmetic as well
+  mp_set_memory_functions(&countingMalloc, &countingGmpRealloc, &gmpFree);
+  pbc_set_memory_functions(&countingMalloc, &countingRealloc, &std::free);
+
+  std::ofstream file;
+  if (!outputFile.empty()) {
+    file.open(outputFile);
+    if (!file) {
+      std::cerr << "ERROR: cannot open " << outputFile << std::endl;
+      return 1;
+    }
+  }
+
+  {
+    Runner runner(options, outputFile.empty() ? std::cout : file);
+    benchAbe(runner);
+    benchSymmetric(runner, options);
+  }
+  return 0;
+}
+
+} // namespace bench
+} // namespace ndnabac
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  return ndn::ndnabac::bench::main(argc, argv);
+}
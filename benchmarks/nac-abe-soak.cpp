@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+/**
+ * nac-abe-soak: checks that the ABE engine does not leak under sustained load
+ *
+ * Runs keygen/encrypt/decrypt cycles, with a cipher text wire round trip in each, and
+ * samples the resident set size.  The RSS after the warm-up cycles is the baseline;
+ * the run fails (exit status 1) if RSS later grows past it by more than --max-growth.
+ * Progress samples and the verdict are printed as JSON objects, one per line.
+ */
+
+#include "algo/abe-support.hpp"
+#include "algo/cipher-text.hpp"
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+#include <fstream>
+#include <unistd.h>
+
+namespace ndn {
+namespace ndnabac {
+namespace bench {
+
+size_t
+getRssKb()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  statm >> size >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+int
+main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+
+  size_t nCycles = 1000000;
+  size_t nWarmUp = 1000;
+  size_t sampleEvery = 10000;
+  size_t maxGrowthKb = 1024;
+  po::options_description description("Usage: nac-abe-soak [options]\n\nOptions");
+  description.add_options()
+    ("help,h", "print this help message and exit")
+    ("cycles,n", po::value<size_t>(&nCycles)->default_value(nCycles),
+     "keygen/encrypt/decrypt cycles to run after the warm-up")
+    ("warm-up,w", po::value<size_t>(&nWarmUp)->default_value(nWarmUp),
+     "cycles to run before taking the baseline RSS")
+    ("sample-every,s", po::value<size_t>(&sampleEvery)->default_value(sampleEvery),
+     "print the RSS every this many cycles")
+    ("max-growth,g", po::value<size_t>(&maxGrowthKb)->default_value(maxGrowthKb),
+     "largest allowed RSS growth over the baseline, in KiB")
+    ;
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, description), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n\n" << description << std::endl;
+    return 2;
+  }
+  if (vm.count("help") > 0) {
+    std::cout << description << std::endl;
+    return 0;
+  }
+  if (sampleEvery == 0) {
+    sampleEvery = 1;
+  }
+
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  std::vector<std::string> attrList = {"attr0", "attr1", "attr2"};
+  const std::string policy = "attr0 attr1 attr3 2of3";
+  Buffer payload(1024);
+
+  auto runCycle = [&] {
+    auto prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+    auto cipherText = algo::ABESupport::encrypt(pubParams, policy, payload);
+    algo::CipherText decoded;
+    decoded.wireDecode(cipherText.wireEncode());
+    auto plainText = algo::ABESupport::decrypt(pubParams, prvKey, decoded);
+    if (plainText != payload) {
+      BOOST_THROW_EXCEPTION(std::runtime_error("Decryption does not match the payload"));
+    }
+  };
+
+  for (size_t i = 0; i < nWarmUp; i++) {
+    runCycle();
+  }
+  size_t baselineKb = getRssKb();
+  size_t peakKb = baselineKb;
+  std::cout << "{\"cycle\": 0, \"rss_kb\": " << baselineKb << "}" << std::endl;
+
+  for (size_t i = 1; i <= nCycles; i++) {
+    runCycle();
+    if (i % sampleEvery == 0 || i == nCycles) {
+      size_t rssKb = getRssKb();
+      peakKb = std::max(peakKb, rssKb);
+      std::cout << "{\"cycle\": " << i << ", \"rss_kb\": " << rssKb << "}" << std::endl;
+    }
+  }
+
+  size_t growthKb = peakKb - baselineKb;
+  bool isFlat = growthKb <= maxGrowthKb;
+  std::cout << "{\"cycles\": " << nCycles << ", \"baseline_rss_kb\": " << baselineKb
+            << ", \"peak_rss_kb\": " << peakKb << ", \"growth_kb\": " << growthKb
+            << ", \"flat\": " << (isFlat ? "true" : "false") << "}" << std::endl;
+  return isFlat ? 0 : 1;
+}
+
+} // namespace bench
+} // namespace ndnabac
+} // namespace ndn
+
+int
+main(int argc, char** argv)
+{
+  return ndn::ndnabac::bench::main(argc, argv);
+}
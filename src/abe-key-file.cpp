@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "abe-key-file.hpp"
+#include "ndn-crypto/data-enc-dec.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <fstream>
+
+namespace ndn {
+namespace ndnabac {
+
+namespace fs = boost::filesystem;
+
+NDN_LOG_INIT(ndnabac.abe-key-file);
+
+void
+AbeKeyFile::save(const std::string& path, const algo::PublicParams& pubParams,
+                 const algo::MasterKey& masterKey, const security::v2::Certificate& cert)
+{
+  auto keys = makeEmptyBlock(tlv::Content);
+  auto pubBuffer = pubParams.toBuffer();
+  keys.push_back(makeBinaryBlock(TLV_PublicParams, pubBuffer.data(), pubBuffer.size()));
+  auto mskBuffer = masterKey.toBuffer();
+  keys.push_back(makeBinaryBlock(TLV_MasterKey, mskBuffer.data(), mskBuffer.size()));
+  keys.encode();
+
+  auto sealed = encryptDataContentWithCK(keys.wire(), keys.size(),
+                                         cert.getPublicKey().data(), cert.getPublicKey().size());
+
+  // a reader never sees a partly written file
+  std::string tmpPath = path + ".tmp";
+  std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+  os.write(reinterpret_cast<const char*>(sealed.wire()), sealed.size());
+  os.close();
+  if (!os) {
+    BOOST_THROW_EXCEPTION(Error("Cannot write " + tmpPath));
+  }
+  boost::system::error_code ec;
+  fs::rename(tmpPath, path, ec);
+  if (ec) {
+    BOOST_THROW_EXCEPTION(Error("Cannot replace " + path + ": " + ec.message()));
+  }
+  NDN_LOG_INFO("Saved ABE keys to " << path);
+}
+
+bool
+AbeKeyFile::load(const std::string& path, const security::Tpm& tpm, const Name& certName,
+                 algo::PublicParams& pubParams, algo::MasterKey& masterKey)
+{
+  if (!fs::exists(path)) {
+    return false;
+  }
+
+  try {
+    boost::iostreams::mapped_file_source file(path);
+    Block sealed(reinterpret_cast<const uint8_t*>(file.data()), file.size());
+    auto keysBuffer = decryptDataContent(sealed, tpm, certName);
+
+    Block keys(keysBuffer.data(), keysBuffer.size());
+    keys.parse();
+    const auto& pub = keys.get(TLV_PublicParams);
+    const auto& msk = keys.get(TLV_MasterKey);
+    pubParams.fromBuffer(Buffer(pub.value(), pub.value_size()));
+    masterKey.fromBuffer(Buffer(msk.value(), msk.value_size()));
+  }
+  catch (const std::exception& e) {
+    BOOST_THROW_EXCEPTION(Error("Cannot load ABE keys from " + path + ": " + e.what()));
+  }
+  NDN_LOG_INFO("Loaded ABE keys from " << path);
+  return true;
+}
+
+} // namespace ndnabac
+} // namespace ndn
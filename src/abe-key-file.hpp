@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ABE_KEY_FILE_HPP
+#define NDNABAC_ABE_KEY_FILE_HPP
+
+#include "common.hpp"
+#include "algo/public-params.hpp"
+#include "algo/master-key.hpp"
+
+namespace ndn {
+namespace ndnabac {
+
+/**
+ * @brief On-disk form of an attribute authority's public parameters and master key
+ *
+ * The file holds a Content block as made by encryptDataContentWithCK: both keys, encoded
+ * as PublicParams and MasterKey TLVs, are encrypted under a random AES key that is
+ * wrapped with the RSA key of the authority's certificate.  It can only be opened with
+ * the KeyChain holding that private key, which replicas of the authority share.
+ */
+class AbeKeyFile
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /**
+   * @brief Write the keys to @p path, replacing the file as a whole
+   * @param cert the certificate whose (RSA) public key seals the file
+   * @throw Error the file cannot be written
+   */
+  static void
+  save(const std::string& path, const algo::PublicParams& pubParams,
+       const algo::MasterKey& masterKey, const security::v2::Certificate& cert);
+
+  /**
+   * @brief Read the keys from @p path
+   * @param certName the certificate whose private key in @p tpm unseals the file
+   * @return false if @p path does not exist
+   * @throw Error the file is malformed or cannot be unsealed
+   */
+  static bool
+  load(const std::string& path, const security::Tpm& tpm, const Name& certName,
+       algo::PublicParams& pubParams, algo::MasterKey& masterKey);
+};
+
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ABE_KEY_FILE_HPP
@@ -19,7 +19,17 @@
  */
 
 #include "abe-support.hpp"
+#include "bswabe-codec.hpp"
+
 #include <ndn-cxx/util/logger.hpp>
+#include <ndn-cxx/util/random.hpp>
+
+#include <openssl/hmac.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
 
 namespace ndn {
 namespace ndnabac {
@@ -27,42 +37,820 @@ namespace algo {
 
 NDN_LOG_INIT(ndnabac.ABESupport);
 
+const size_t ABESupport::PARALLEL_ENCRYPT_MIN_LEAVES = 32;
+const size_t ABESupport::PARALLEL_DECRYPT_MIN_LEAVES = 8;
+const size_t ABESupport::PARALLEL_MIN_CHUNKS = 4;
+const size_t ABESupport::DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+namespace {
+
+/**
+ * pbc opens its entropy source lazily on the first element_random, which races when
+ * that first call happens on several threads at once.  Open it up front instead.
+ */
+void
+initRandom()
+{
+  static std::once_flag once;
+  std::call_once(once, [] {
+      pbc_random_set_file(const_cast<char*>("/dev/urandom"));
+    });
+}
+
+/**
+ * Workers for the per-leaf work of wide policies, shared by all encryptions and decryptions.
+ */
+ThreadPool&
+getLeafPool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+/**
+ * Call @p process on contiguous ranges covering [0, @p n).  The ranges run on
+ * getLeafPool() when @p n is at least @p minParallel, else @p process is called once.
+ */
+void
+processInRanges(size_t n, size_t minParallel, const function<void(size_t, size_t)>& process)
+{
+  auto& pool = getLeafPool();
+  if (n < minParallel || pool.size() < 2) {
+    process(0, n);
+    return;
+  }
+
+  size_t nChunks = std::min(pool.size(), n);
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < nChunks; i++) {
+    size_t begin = n * i / nChunks;
+    size_t end = n * (i + 1) / nChunks;
+    futures.push_back(pool.submit([&process, begin, end] { process(begin, end); }));
+  }
+  // every range refers to the caller's state, so let all of them finish before rethrowing
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+/**
+ * Per-leaf values of one encryption, indexed by CompiledPolicy::Node::leafIndex.
+ */
+struct LeafComponents : noncopyable
+{
+  LeafComponents(size_t nLeaves, pairing_ptr pairing)
+    : share(nLeaves)
+    , c(nLeaves)
+    , cp(nLeaves)
+  {
+    for (size_t i = 0; i < nLeaves; i++) {
+      element_init_Zr(&share[i], pairing);
+      element_init_G1(&c[i], pairing);
+      element_init_G2(&cp[i], pairing);
+    }
+  }
+
+  ~LeafComponents()
+  {
+    for (size_t i = 0; i < share.size(); i++) {
+      element_clear(&share[i]);
+      element_clear(&c[i]);
+      element_clear(&cp[i]);
+    }
+  }
+
+  std::vector<element_s> share; // Zr, q_y(0)
+  std::vector<element_s> c;     // G1, g^q_y(0)
+  std::vector<element_s> cp;    // G2, H(attr)^q_y(0)
+};
+
+/**
+ * Split @p secret over the subtree at @p node and store the share of every leaf.
+ */
+void
+splitSecret(const CompiledPolicy::Node& node, element_t secret, pairing_ptr pairing,
+            LeafComponents& leaves)
+{
+  if (node.isLeaf()) {
+    element_set(&leaves.share[node.leafIndex], secret);
+    return;
+  }
+
+  // random polynomial q of degree k - 1 with q(0) = secret
+  std::vector<element_s> coef(node.k);
+  element_init_Zr(&coef[0], pairing);
+  element_set(&coef[0], secret);
+  for (int i = 1; i < node.k; i++) {
+    element_init_Zr(&coef[i], pairing);
+    element_random(&coef[i]);
+  }
+
+  element_t x, share, term;
+  element_init_Zr(x, pairing);
+  element_init_Zr(share, pairing);
+  element_init_Zr(term, pairing);
+  for (size_t i = 0; i < node.children.size(); i++) {
+    // child i gets q(i + 1), evaluated with Horner's rule
+    element_set_si(x, static_cast<signed long>(i + 1));
+    element_set(share, &coef[node.k - 1]);
+    for (int j = node.k - 2; j >= 0; j--) {
+      element_mul(term, share, x);
+      element_add(share, term, &coef[j]);
+    }
+    splitSecret(node.children[i], share, pairing, leaves);
+  }
+
+  element_clear(x);
+  element_clear(share);
+  element_clear(term);
+  for (auto& e : coef) {
+    element_clear(&e);
+  }
+}
+
+/**
+ * Raise g and H(attr) to the shares of leaves [@p begin, @p end).
+ * Only reads the shared tables and hashes, so disjoint ranges can run concurrently.
+ */
+void
+exponentiateLeaves(const CompiledPolicy::LeafHashes& hashes, LeafComponents& leaves,
+                   size_t begin, size_t end)
+{
+  auto gTable = const_cast<element_pp_s*>(hashes.getPublicParams().gTable);
+  for (size_t i = begin; i < end; i++) {
+    element_pp_pow_zn(&leaves.c[i], &leaves.share[i], gTable);
+    element_pow_zn(&leaves.cp[i], hashes.at(i), &leaves.share[i]);
+  }
+}
+
+/**
+ * Append the subtree at @p node, in bswabe_cph_serialize order, to @p buf.
+ */
+void
+writePolicy(const CompiledPolicy::Node& node, LeafComponents& leaves, GByteArray* buf)
+{
+  BswabeCodec::appendUint32(buf, static_cast<uint32_t>(node.k));
+  BswabeCodec::appendUint32(buf, static_cast<uint32_t>(node.children.size()));
+
+  if (node.isLeaf()) {
+    BswabeCodec::appendString(buf, node.attr);
+    BswabeCodec::appendElement(buf, &leaves.c[node.leafIndex]);
+    BswabeCodec::appendElement(buf, &leaves.cp[node.leafIndex]);
+    return;
+  }
+  for (const auto& child : node.children) {
+    writePolicy(child, leaves, buf);
+  }
+}
+
+/**
+ * Split @p secret over @p policy and append the resulting ciphertext components to @p buf.
+ * Policies with at least ABESupport::PARALLEL_ENCRYPT_MIN_LEAVES leaves have their
+ * exponentiations spread over getLeafPool(); the output is the same either way.
+ */
+void
+fillPolicy(const CompiledPolicy& policy, const CompiledPolicy::LeafHashes& hashes,
+           element_t secret, GByteArray* buf)
+{
+  pairing_ptr pairing = hashes.getPublicParams().pairing.get();
+  size_t nLeaves = policy.getLeafAttributes().size();
+  LeafComponents leaves(nLeaves, pairing);
+  splitSecret(policy.getRoot(), secret, pairing, leaves);
+
+  processInRanges(nLeaves, ABESupport::PARALLEL_ENCRYPT_MIN_LEAVES,
+                  [&hashes, &leaves] (size_t begin, size_t end) {
+                    exponentiateLeaves(hashes, leaves, begin, end);
+                  });
+
+  writePolicy(policy.getRoot(), leaves, buf);
+}
+
+/**
+ * A cipher text policy node decoded for decryption, annotated with what the
+ * decrypting key can satisfy.
+ */
+struct CipherNode : noncopyable
+{
+  ~CipherNode()
+  {
+    if (isLeaf) {
+      element_clear(c);
+      element_clear(cp);
+    }
+  }
+
+  int k = 1;
+  bool isLeaf = false;
+  std::string attr;
+  element_t c;  // G1, leaves only
+  element_t cp; // G2, leaves only
+  std::vector<unique_ptr<CipherNode>> children;
+
+  const DecodedPrivateKey::Component* comp = nullptr;
+  bool satisfiable = false;
+  int minLeaves = 0;
+  std::vector<int> satl; // 1-based indexes of the children to combine
+};
+
+unique_ptr<CipherNode>
+readCipherNode(const PreparedPublicParams& pub, const GByteArray* buf, size_t& offset)
+{
+  pairing_ptr pairing = pub.pairing.get();
+  auto node = make_unique<CipherNode>();
+  node->k = static_cast<int>(BswabeCodec::readUint32(buf, offset));
+  uint32_t nChildren = BswabeCodec::readUint32(buf, offset);
+  if (nChildren == 0) {
+    node->attr = BswabeCodec::readString(buf, offset);
+    element_init_G1(node->c, pairing);
+    element_init_G2(node->cp, pairing);
+    node->isLeaf = true;
+    BswabeCodec::readElement(buf, offset, node->c);
+    BswabeCodec::readElement(buf, offset, node->cp);
+  }
+  for (uint32_t i = 0; i < nChildren; i++) {
+    node->children.push_back(readCipherNode(pub, buf, offset));
+  }
+  return node;
+}
+
+struct DecodedCipherText : noncopyable
+{
+  DecodedCipherText(const PreparedPublicParams& pub, const GByteArray* buf)
+  {
+    pairing_ptr pairing = pub.pairing.get();
+    element_init_GT(cs, pairing);
+    element_init_G1(c, pairing);
+    try {
+      size_t offset = 0;
+      BswabeCodec::readElement(buf, offset, cs);
+      BswabeCodec::readElement(buf, offset, c);
+      policy = readCipherNode(pub, buf, offset);
+    }
+    catch (const BswabeCodec::Error&) {
+      element_clear(cs);
+      element_clear(c);
+      throw;
+    }
+  }
+
+  ~DecodedCipherText()
+  {
+    element_clear(cs);
+    element_clear(c);
+  }
+
+  element_t cs; // GT
+  element_t c;  // G1
+  unique_ptr<CipherNode> policy;
+};
+
+void
+checkSatisfiable(CipherNode& node, const DecodedPrivateKey& prvKey)
+{
+  if (node.isLeaf) {
+    node.comp = prvKey.findComponent(node.attr);
+    node.satisfiable = node.comp != nullptr;
+    return;
+  }
+
+  int nSatisfied = 0;
+  for (auto& child : node.children) {
+    checkSatisfiable(*child, prvKey);
+    if (child->satisfiable) {
+      nSatisfied++;
+    }
+  }
+  node.satisfiable = nSatisfied >= node.k;
+}
+
+/**
+ * Pick, for every gate, the k satisfiable children that need the fewest leaves.
+ */
+void
+pickMinLeaves(CipherNode& node)
+{
+  if (node.isLeaf) {
+    node.minLeaves = 1;
+    return;
+  }
+
+  std::vector<int> candidates;
+  for (size_t i = 0; i < node.children.size(); i++) {
+    if (node.children[i]->satisfiable) {
+      pickMinLeaves(*node.children[i]);
+      candidates.push_back(static_cast<int>(i));
+    }
+  }
+  std::stable_sort(candidates.begin(), candidates.end(), [&node] (int a, int b) {
+      return node.children[a]->minLeaves < node.children[b]->minLeaves;
+    });
+
+  node.minLeaves = 0;
+  node.satl.clear();
+  for (size_t i = 0; i < candidates.size() && static_cast<int>(i) < node.k; i++) {
+    node.minLeaves += node.children[candidates[i]]->minLeaves;
+    node.satl.push_back(candidates[i] + 1);
+  }
+}
+
+void
+lagrangeCoef(element_t r, const std::vector<int>& satl, int i, pairing_ptr pairing)
+{
+  element_t t;
+  element_init_Zr(t, pairing);
+  element_set1(r);
+  for (int j : satl) {
+    if (j == i) {
+      continue;
+    }
+    element_set_si(t, -j);
+    element_mul(r, r, t);
+    element_set_si(t, i - j);
+    element_invert(t, t);
+    element_mul(r, r, t);
+  }
+  element_clear(t);
+}
+
+/**
+ * The leaves whose pairings a decryption needs, with the product of the Lagrange
+ * coefficients on the path to each of them.
+ */
+struct DecryptionPlan : noncopyable
+{
+  explicit
+  DecryptionPlan(pairing_ptr pairing)
+    : pairing(pairing)
+  {
+  }
+
+  ~DecryptionPlan()
+  {
+    for (auto& coef : coefs) {
+      element_clear(&coef);
+    }
+  }
+
+  void
+  add(const CipherNode& leaf, element_t coef)
+  {
+    leaves.push_back(&leaf);
+    coefs.emplace_back();
+    element_init_Zr(&coefs.back(), pairing);
+    element_set(&coefs.back(), coef);
+  }
+
+  pairing_ptr pairing;
+  std::vector<const CipherNode*> leaves;
+  std::vector<element_s> coefs; // Zr
+};
+
+/**
+ * Add the leaves picked by pickMinLeaves under @p node to @p plan, with @p exp
+ * multiplied by the Lagrange coefficients on their paths.
+ */
+void
+planNode(DecryptionPlan& plan, element_t exp, const CipherNode& node)
+{
+  if (node.isLeaf) {
+    plan.add(node, exp);
+    return;
+  }
+
+  element_t coef, expNew;
+  element_init_Zr(coef, plan.pairing);
+  element_init_Zr(expNew, plan.pairing);
+  for (int i : node.satl) {
+    lagrangeCoef(coef, node.satl, i, plan.pairing);
+    element_mul(expNew, exp, coef);
+    planNode(plan, expNew, *node.children[i - 1]);
+  }
+  element_clear(coef);
+  element_clear(expNew);
+}
+
+/**
+ * Set @p r to e(g,g)^(rs) / e(C, D), the product over the planned leaves of
+ * e(C_y^coef, D_j) * e(D'_j, C'_y^-coef), times e(C^-1, D).
+ *
+ * All of it is one product of pairings, so it needs a single final exponentiation.
+ * Wide plans are split into one product per worker of getLeafPool().
+ */
+void
+evaluateProduct(element_t r, const DecryptionPlan& plan, const DecodedCipherText& cph,
+                const DecodedPrivateKey& prvKey)
+{
+  const Pairing& pairing = prvKey.getPublicParams().pairing;
+  size_t n = plan.leaves.size();
+  std::mutex mutex;
+  element_set1(r);
+
+  processInRanges(n, ABESupport::PARALLEL_DECRYPT_MIN_LEAVES,
+                  [&] (size_t begin, size_t end) {
+                    std::vector<G1> lhs;
+                    std::vector<G2> rhs;
+                    ZP negCoef = pairing.initZP();
+                    for (size_t i = begin; i < end; i++) {
+                      const CipherNode& leaf = *plan.leaves[i];
+                      element_ptr coef = const_cast<element_ptr>(&plan.coefs[i]);
+                      // coef is 1 when each gate above the leaf has a single child satisfied
+                      bool isOne = element_is1(coef);
+
+                      lhs.push_back(pairing.initG1());
+                      if (isOne) {
+                        element_set(lhs.back().get(), const_cast<element_ptr>(leaf.c));
+                      }
+                      else {
+                        element_pow_zn(lhs.back().get(), const_cast<element_ptr>(leaf.c), coef);
+                      }
+                      rhs.push_back(pairing.initG2());
+                      element_set(rhs.back().get(), const_cast<element_ptr>(leaf.comp->d));
+
+                      lhs.push_back(pairing.initG1());
+                      element_set(lhs.back().get(), const_cast<element_ptr>(leaf.comp->dp));
+                      rhs.push_back(pairing.initG2());
+                      if (isOne) {
+                        element_invert(rhs.back().get(), const_cast<element_ptr>(leaf.cp));
+                      }
+                      else {
+                        element_neg(negCoef.get(), coef);
+                        element_pow_zn(rhs.back().get(), const_cast<element_ptr>(leaf.cp),
+                                       negCoef.get());
+                      }
+                    }
+                    if (end == n) {
+                      lhs.push_back(pairing.initG1());
+                      element_invert(lhs.back().get(), const_cast<element_ptr>(cph.c));
+                      rhs.push_back(pairing.initG2());
+                      element_set(rhs.back().get(), const_cast<element_ptr>(prvKey.d));
+                    }
+
+                    GT product = pairing.initGT();
+                    pairing.multi_pairing(product, lhs, rhs);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    element_mul(r, r, product.get());
+                  });
+}
+
+/**
+ * Same result as evaluateProduct, for a key with preprocessed pairings: each leaf is
+ * [e(D_j, C_y) / e(D'_j, C'_y)]^coef, exponentiated in GT only when coef is not 1.
+ *
+ * Each pairing pays its own final exponentiation, but the Miller loops run from the
+ * key's tables and no G1/G2 exponentiation is needed.  Compare both with the "decrypt"
+ * and "decrypt-unprepared" cases of nac-abe-bench.
+ */
+void
+evaluatePreprocessed(element_t r, const DecryptionPlan& plan, const DecodedCipherText& cph,
+                     const DecodedPrivateKey& prvKey)
+{
+  const Pairing& pairing = prvKey.getPublicParams().pairing;
+  size_t n = plan.leaves.size();
+  std::mutex mutex;
+  element_set1(r);
+
+  processInRanges(n, ABESupport::PARALLEL_DECRYPT_MIN_LEAVES,
+                  [&] (size_t begin, size_t end) {
+                    GT product = pairing.initGT();
+                    GT num = pairing.initGT();
+                    GT den = pairing.initGT();
+                    element_set1(product.get());
+                    for (size_t i = begin; i < end; i++) {
+                      const CipherNode& leaf = *plan.leaves[i];
+                      element_ptr coef = const_cast<element_ptr>(&plan.coefs[i]);
+                      pairing_pp_apply(num.get(), const_cast<element_ptr>(leaf.c),
+                                       const_cast<pairing_pp_ptr>(leaf.comp->dPp));
+                      pairing_pp_apply(den.get(), const_cast<element_ptr>(leaf.cp),
+                                       const_cast<pairing_pp_ptr>(leaf.comp->dpPp));
+                      element_div(num.get(), num.get(), den.get());
+                      if (!element_is1(coef)) {
+                        element_pow_zn(num.get(), num.get(), coef);
+                      }
+                      element_mul(product.get(), product.get(), num.get());
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    element_mul(r, r, product.get());
+                  });
+
+  GT t = pairing.initGT();
+  pairing_pp_apply(t.get(), const_cast<element_ptr>(cph.c),
+                   const_cast<pairing_pp_ptr>(prvKey.dPp));
+  element_div(r, r, t.get());
+}
+
+void
+evaluatePlan(element_t r, const DecryptionPlan& plan, const DecodedCipherText& cph,
+             const DecodedPrivateKey& prvKey)
+{
+  if (prvKey.isPreprocessed()) {
+    evaluatePreprocessed(r, plan, cph, prvKey);
+  }
+  else {
+    evaluateProduct(r, plan, cph, prvKey);
+  }
+}
+
+/**
+ * ABE-encrypt a random element m of GT under @p policy into @p result.m_cph.
+ * @return m, from which the symmetric key is derived
+ */
+GT
+encapsulate(const PublicParams& pubParams, const CompiledPolicy& policy, CipherText& result)
+{
+  auto pub = pubParams.getPrepared();
+  if (pub == nullptr) {
+    BOOST_THROW_EXCEPTION(ABESupport::Error("Public parameters are required for encryption"));
+  }
+  initRandom();
+  auto hashes = policy.getLeafHashes(pub);
+  const Pairing& pairing = pub->pairing;
+
+  // C~ = m * e(g,g)^(alpha s), C = h^s
+  GT m = pairing.initGT();
+  element_random(m.get());
+  ZP s = pairing.randomZP();
+  GT cs = pairing.initGT();
+  G1 c = pairing.initG1();
+  element_pp_pow_zn(cs.get(), s.get(), const_cast<element_pp_s*>(pub->gHatAlphaTable));
+  element_mul(cs.get(), cs.get(), m.get());
+  element_pp_pow_zn(c.get(), s.get(), const_cast<element_pp_s*>(pub->hTable));
+
+  result.m_cph = makeByteArray();
+  BswabeCodec::appendElement(result.m_cph.get(), cs.get());
+  BswabeCodec::appendElement(result.m_cph.get(), c.get());
+  fillPolicy(policy, *hashes, s.get(), result.m_cph.get());
+  return m;
+}
+
+/**
+ * Recover the element m that @p cipherText.m_cph encrypts.
+ * @throw ABESupport::Error the attributes in @p prvKey do not satisfy the policy
+ */
+GT
+decapsulate(const DecodedPrivateKey& prvKey, const CipherText& cipherText)
+{
+  const auto& pub = prvKey.getPublicParams();
+  const Pairing& pairing = pub.pairing;
+
+  DecodedCipherText cph(pub, cipherText.m_cph.get());
+  checkSatisfiable(*cph.policy, prvKey);
+  if (!cph.policy->satisfiable) {
+    BOOST_THROW_EXCEPTION(ABESupport::Error("Cannot decrypt, attributes in key do not satisfy policy"));
+  }
+  pickMinLeaves(*cph.policy);
+
+  // m = C~ * e(g,g)^(rs) / e(C, D)
+  ZP one = pairing.initZP();
+  element_set1(one.get());
+  DecryptionPlan plan(pairing.get());
+  planNode(plan, one.get(), *cph.policy);
+  NDN_LOG_TRACE("decrypting with " << plan.leaves.size() << " leaf pairings");
+  GT m = pairing.initGT();
+  evaluatePlan(m.get(), plan, cph, prvKey);
+  element_mul(m.get(), cph.cs, m.get());
+  return m;
+}
+
+/**
+ * Write [zero padding][length, big endian], the part of the padded plain text before
+ * the payload, to @p out.
+ * @return the number of bytes written
+ */
+size_t
+writeAes128Header(uint8_t* out, size_t size)
+{
+  size_t headerLen = ABESupport::getAes128EncryptedSize(size) - size;
+  uint8_t* len = out + headerLen - 4;
+  std::fill(out, len, 0);
+  len[0] = (size & 0xff000000) >> 24;
+  len[1] = (size & 0xff0000) >> 16;
+  len[2] = (size & 0xff00) >> 8;
+  len[3] = (size & 0xff) >> 0;
+  return headerLen;
+}
+
+const size_t AES_256_GCM_KEY_SIZE = 32;
+const size_t AES_256_GCM_NONCE_SIZE = 12;
+const size_t AES_256_GCM_TAG_SIZE = 16;
+
+// HKDF info, binds the derived key to its use
+const char HKDF_INFO[] = "ndnabac content key AES-256-GCM";
+const char HKDF_INFO_CHUNKED[] = "ndnabac content key AES-256-GCM-CHUNKED";
+
+using CipherContextPtr = std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>;
+
+/**
+ * HKDF-SHA256 (RFC 5869) of @p ikm with no salt, @p size bytes of output
+ */
+Buffer
+hkdfSha256(const Buffer& ikm, const std::string& info, size_t size)
+{
+  uint8_t salt[SHA256_DIGEST_LENGTH] = {0};
+  uint8_t prk[SHA256_DIGEST_LENGTH];
+  unsigned int prkLen = 0;
+  HMAC(EVP_sha256(), salt, sizeof(salt), ikm.data(), ikm.size(), prk, &prkLen);
+
+  // T(i) = HMAC(PRK, T(i-1) | info | i)
+  Buffer okm(size);
+  std::vector<uint8_t> input;
+  uint8_t t[SHA256_DIGEST_LENGTH];
+  unsigned int tLen = 0;
+  uint8_t counter = 1;
+  for (size_t offset = 0; offset < size; offset += tLen, counter++) {
+    input.insert(input.end(), info.begin(), info.end());
+    input.push_back(counter);
+    HMAC(EVP_sha256(), prk, prkLen, input.data(), input.size(), t, &tLen);
+    std::copy(t, t + std::min<size_t>(tLen, size - offset), okm.data() + offset);
+    input.assign(t, t + tLen);
+  }
+
+  OPENSSL_cleanse(prk, sizeof(prk));
+  OPENSSL_cleanse(t, sizeof(t));
+  OPENSSL_cleanse(input.data(), input.size());
+  return okm;
+}
+
+Buffer
+hkdfFromElement(element_t k, const std::string& info, size_t size)
+{
+  Buffer ikm(element_length_in_bytes(k));
+  element_to_bytes(ikm.data(), k);
+  auto okm = hkdfSha256(ikm, info, size);
+  OPENSSL_cleanse(ikm.data(), ikm.size());
+  return okm;
+}
+
+/**
+ * Encrypt @p size bytes at @p data in place, writing the tag to @p tag.
+ */
+void
+gcmSeal(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadSize,
+        uint8_t* data, size_t size, uint8_t* tag)
+{
+  CipherContextPtr ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+  int len = 0;
+  if (ctx == nullptr ||
+      EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, AES_256_GCM_NONCE_SIZE, nullptr) != 1 ||
+      EVP_EncryptInit_ex(ctx.get(), nullptr, nullptr, key, nonce) != 1 ||
+      (aadSize > 0 &&
+       EVP_EncryptUpdate(ctx.get(), nullptr, &len, aad, static_cast<int>(aadSize)) != 1) ||
+      EVP_EncryptUpdate(ctx.get(), data, &len, data, static_cast<int>(size)) != 1 ||
+      EVP_EncryptFinal_ex(ctx.get(), data + len, &len) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, AES_256_GCM_TAG_SIZE, tag) != 1) {
+    BOOST_THROW_EXCEPTION(ABESupport::Error("AES-256-GCM encryption failed"));
+  }
+}
+
+/**
+ * Decrypt @p size bytes at @p in, followed by their tag, to @p out.
+ * @throw ABESupport::Error the tag does not verify
+ */
+void
+gcmOpen(const uint8_t* key, const uint8_t* nonce, const uint8_t* aad, size_t aadSize,
+        const uint8_t* in, size_t size, uint8_t* out)
+{
+  // EVP takes the expected tag through a non-const pointer
+  uint8_t tag[AES_256_GCM_TAG_SIZE];
+  std::copy(in + size, in + size + AES_256_GCM_TAG_SIZE, tag);
+
+  CipherContextPtr ctx(EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+  int len = 0;
+  if (ctx == nullptr ||
+      EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr, nullptr) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, AES_256_GCM_NONCE_SIZE, nullptr) != 1 ||
+      EVP_DecryptInit_ex(ctx.get(), nullptr, nullptr, key, nonce) != 1 ||
+      (aadSize > 0 &&
+       EVP_DecryptUpdate(ctx.get(), nullptr, &len, aad, static_cast<int>(aadSize)) != 1) ||
+      EVP_DecryptUpdate(ctx.get(), out, &len, in, static_cast<int>(size)) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, AES_256_GCM_TAG_SIZE, tag) != 1) {
+    BOOST_THROW_EXCEPTION(ABESupport::Error("AES-256-GCM decryption failed"));
+  }
+  if (EVP_DecryptFinal_ex(ctx.get(), out + len, &len) != 1) {
+    OPENSSL_cleanse(out, size);
+    BOOST_THROW_EXCEPTION(ABESupport::Error("Content fails AES-256-GCM authentication"));
+  }
+}
+
+/**
+ * Chunk @p index of chunked content: its nonce is the nonce base XOR the big-endian
+ * index, and its associated data flags the last chunk, so that a truncated content
+ * does not authenticate.
+ */
+struct Chunk
+{
+  Chunk(const Buffer& contentKey, uint64_t index, bool isLast)
+    : key(contentKey.data())
+    , isLast(isLast ? 1 : 0)
+  {
+    std::copy(contentKey.begin() + AES_256_GCM_KEY_SIZE, contentKey.end(), nonce);
+    for (size_t i = 0; i < 8; i++) {
+      nonce[AES_256_GCM_NONCE_SIZE - 1 - i] ^= static_cast<uint8_t>(index >> (8 * i));
+    }
+  }
+
+  const uint8_t* key;
+  uint8_t nonce[AES_256_GCM_NONCE_SIZE];
+  uint8_t isLast;
+};
+
+void
+checkChunkedKey(const Buffer& contentKey)
+{
+  if (contentKey.size() != AES_256_GCM_KEY_SIZE + AES_256_GCM_NONCE_SIZE) {
+    BOOST_THROW_EXCEPTION(ABESupport::Error("Invalid chunked content key"));
+  }
+}
+
+/**
+ * Encrypt in place the chunks of @p plainTextSize bytes laid out at @p data, each chunk
+ * followed by room for its tag.
+ */
+void
+sealChunks(const Buffer& contentKey, uint8_t* data, size_t plainTextSize, size_t chunkSize)
+{
+  size_t nChunks = ABESupport::getChunkCount(
+    ABESupport::getChunkedEncryptedSize(plainTextSize, chunkSize), chunkSize);
+  size_t stride = chunkSize + AES_256_GCM_TAG_SIZE;
+  processInRanges(nChunks, ABESupport::PARALLEL_MIN_CHUNKS,
+                  [&] (size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                      Chunk chunk(contentKey, i, i + 1 == nChunks);
+                      size_t size = std::min(chunkSize, plainTextSize - i * chunkSize);
+                      uint8_t* text = data + i * stride;
+                      gcmSeal(chunk.key, chunk.nonce, &chunk.isLast, 1, text, size, text + size);
+                    }
+                  });
+}
+
+} // namespace
+
 void
 ABESupport::setup(PublicParams& pubParams, MasterKey& masterKey)
 {
   bswabe_pub_t* pub;
   bswabe_msk_t* msk;
   bswabe_setup(&pub, &msk);
+  BswabePubPtr pubOwner(pub);
+  BswabeMskPtr mskOwner(msk);
 
-  pubParams.m_pub = bswabe_pub_serialize(pub);
-  masterKey.m_msk = bswabe_msk_serialize(msk);
+  pubParams = PublicParams();
+  pubParams.m_pub.reset(bswabe_pub_serialize(pub));
+  masterKey = MasterKey();
+  masterKey.m_msk.reset(bswabe_msk_serialize(msk));
 }
 
 PrivateKey
-ABESupport::prvKeyGen(PublicParams& pubParams, MasterKey& masterKey,
+ABESupport::prvKeyGen(const PublicParams& pubParams, const MasterKey& masterKey,
                       const std::vector<std::string>& attrList)
 {
-  // change list<string> to char**
-  char** attrs = new char*[attrList.size() + 1];
-  for (size_t i = 0; i < attrList.size(); i++) {
-    char *cstr = new char[attrList[i].length() + 1];
-    std::strcpy(cstr, attrList[i].c_str());
-    cstr[attrList[i].length()] = 0;
-    attrs[i] = cstr;
+  auto msk = masterKey.getPrepared(pubParams);
+  if (msk == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Public parameters and master key are required for key generation"));
   }
-  attrs[attrList.size()] = 0;
+  initRandom();
+  const auto& pub = msk->getPublicParams();
+  const Pairing& pairing = pub->pairing;
+  auto gTable = const_cast<element_pp_s*>(pub->gTable);
+  auto gpTable = const_cast<element_pp_s*>(pub->gpTable);
+  auto& hashCache = AttributeHashCache::getInstance();
+
+  ZP r = pairing.randomZP();
+  ZP rBetaInv = pairing.initZP();
+  G2 gR = pairing.initG2();
+  G2 d = pairing.initG2();
 
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
-  bswabe_msk_t* msk = bswabe_msk_unserialize(pub, masterKey.m_msk, 0);
-  bswabe_prv_t* prv = bswabe_keygen(pub, msk, attrs);
+  // D = (g^alpha * gp^r)^(1/beta) = (g^alpha)^(1/beta) * gp^(r/beta)
+  element_pp_pow_zn(gR.get(), r.get(), gpTable);
+  element_mul(rBetaInv.get(), r.get(), const_cast<element_ptr>(msk->betaInv));
+  element_pp_pow_zn(d.get(), rBetaInv.get(), gpTable);
+  element_mul(d.get(), d.get(), const_cast<element_ptr>(msk->gAlphaBetaInv));
 
   PrivateKey privateKey;
-  privateKey.m_prv = bswabe_prv_serialize(prv);
+  privateKey.m_prv = makeByteArray();
+  GByteArray* prv = privateKey.m_prv.get();
+  BswabeCodec::appendElement(prv, d.get());
+  BswabeCodec::appendUint32(prv, static_cast<uint32_t>(attrList.size()));
 
-  for (size_t i = 0; i < attrList.size(); i++) {
-    delete [] attrs[i];
+  ZP rp = pairing.initZP();
+  G2 hRp = pairing.initG2();
+  G2 dj = pairing.initG2();
+  G1 djp = pairing.initG1();
+  for (const auto& attr : attrList) {
+    // D_j = gp^r * H(j)^r_j, D'_j = g^r_j
+    element_random(rp.get());
+    element_pow_zn(hRp.get(), hashCache.get(pub, attr)->get(), rp.get());
+    element_mul(dj.get(), gR.get(), hRp.get());
+    element_pp_pow_zn(djp.get(), rp.get(), gTable);
+
+    BswabeCodec::appendString(prv, attr);
+    BswabeCodec::appendElement(prv, dj.get());
+    BswabeCodec::appendElement(prv, djp.get());
   }
-  delete [] attrs;
   return privateKey;
 }
 
@@ -70,140 +858,444 @@ CipherText
 ABESupport::encrypt(const PublicParams& pubParams,
                     const std::string& policy, Buffer plainText)
 {
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
-
-  char *policyCharArray = new char[policy.length() + 1];
-  strcpy(policyCharArray, policy.c_str());
+  return encrypt(pubParams, CompiledPolicy(policy), std::move(plainText));
+}
 
-  element_t m;
-  bswabe_cph_t* cph = bswabe_enc(pub, m, policyCharArray);
+CipherText
+ABESupport::encrypt(const PublicParams& pubParams,
+                    const CompiledPolicy& policy, Buffer plainText, CipherSuite suite)
+{
   CipherText result;
-  result.m_cph = bswabe_cph_serialize(cph);
-  bswabe_cph_free(cph);
-  delete [] policyCharArray;
+  GT m = encapsulate(pubParams, policy, result);
+  result.m_suite = suite;
+  result.m_plainTextSize = plainText.size();
 
+  if (suite == CipherSuite::AES_256_GCM) {
+    result.m_content = aes_256_gcm_encrypt(plainText.data(), plainText.size(),
+                                           deriveAes256Key(m.get()));
+    return result;
+  }
   GByteArray content{plainText.data(), static_cast<guint>(plainText.size())};
-  // GByteArray* content = new GByteArray{buf, length};
-  GByteArray* encryptedContent = aes_128_encrypt(&content, m);
-  element_clear(m);
-
+  auto encryptedContent = aes_128_encrypt(&content, m.get());
   result.m_content = Buffer(encryptedContent->data, encryptedContent->len);
-  result.m_plainTextSize = plainText.size();
+  return result;
+}
+
+CipherText
+ABESupport::encryptDeferred(const PublicParams& pubParams, const CompiledPolicy& policy,
+                            const uint8_t* plainText, size_t plainTextSize)
+{
+  CipherText result;
+  GT m = encapsulate(pubParams, policy, result);
+  result.m_suite = CipherSuite::AES_256_GCM;
+  result.m_pendingPlainText = plainText;
+  result.m_pendingKey = deriveKey(result.m_suite, m.get());
+  result.m_plainTextSize = plainTextSize;
+  return result;
+}
+
+CipherText
+ABESupport::encryptChunked(const PublicParams& pubParams, const CompiledPolicy& policy,
+                           const uint8_t* plainText, size_t plainTextSize, size_t chunkSize)
+{
+  if (chunkSize == 0 || chunkSize > std::numeric_limits<uint32_t>::max()) {
+    BOOST_THROW_EXCEPTION(Error("Invalid chunk size " + std::to_string(chunkSize)));
+  }
+  CipherText result;
+  GT m = encapsulate(pubParams, policy, result);
+  result.m_suite = CipherSuite::AES_256_GCM_CHUNKED;
+  result.m_chunkSize = static_cast<uint32_t>(chunkSize);
+  result.m_plainTextSize = plainTextSize;
+  result.m_content = aes_256_gcm_chunked_encrypt(plainText, plainTextSize,
+                                                 deriveChunkedKey(m.get()), chunkSize);
   return result;
 }
 
 Buffer
-ABESupport::decrypt(const PublicParams& pubParams,
-                    const PrivateKey& prvKey, CipherText cipherText)
+ABESupport::decryptContentKey(const DecodedPrivateKey& prvKey, const CipherText& cipherText)
+{
+  GT m = decapsulate(prvKey, cipherText);
+  return deriveKey(cipherText.m_suite, m.get());
+}
+
+std::vector<CipherText>
+ABESupport::encryptBatch(const PublicParams& pubParams, const CompiledPolicy& policy,
+                         const std::vector<Buffer>& plainTexts, ThreadPool& pool)
 {
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
-  bswabe_prv_t* prv = bswabe_prv_unserialize(pub, prvKey.m_prv, 0);
-  bswabe_cph_t* cph = bswabe_cph_unserialize(pub, cipherText.m_cph, 0);
-  element_t m;
+  if (pubParams.getPrepared() == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Public parameters are required for encryption"));
+  }
 
-  if (!bswabe_dec(pub, prv, cph, m)) {
-    NDN_LOG_ERROR("Decryption error!" + std::string(bswabe_error()));
+  std::vector<std::future<CipherText>> futures;
+  futures.reserve(plainTexts.size());
+  for (const auto& plainText : plainTexts) {
+    futures.push_back(pool.submit([&pubParams, &policy, &plainText] {
+          return encrypt(pubParams, policy, plainText);
+        }));
   }
 
-  GByteArray content{cipherText.m_content.data(), static_cast<guint>(cipherText.m_content.size())};
-  GByteArray* result = aes_128_decrypt(&content, m, cipherText.m_plainTextSize);
+  // wait for every task before rethrowing, the tasks refer to our arguments
+  std::vector<CipherText> result;
+  result.reserve(futures.size());
+  std::exception_ptr error;
+  for (auto& future : futures) {
+    try {
+      result.push_back(future.get());
+    }
+    catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  NDN_LOG_DEBUG("encrypted a batch of " << result.size() << " under " << policy.toString());
+  return result;
+}
+
+std::vector<CipherText>
+ABESupport::encryptBatch(const PublicParams& pubParams, const std::string& policy,
+                         const std::vector<Buffer>& plainTexts, ThreadPool& pool)
+{
+  return encryptBatch(pubParams, CompiledPolicy(policy), plainTexts, pool);
+}
+
+Buffer
+ABESupport::decrypt(const PublicParams& pubParams,
+                    const PrivateKey& prvKey, const CipherText& cipherText)
+{
+  return decrypt(DecodedPrivateKey(pubParams, prvKey), cipherText);
+}
+
+Buffer
+ABESupport::decrypt(const DecodedPrivateKey& prvKey, const CipherText& cipherText)
+{
+  return decryptContent(cipherText, decryptContentKey(prvKey, cipherText));
+}
+
+Buffer
+ABESupport::decryptContent(const CipherText& cipherText, const Buffer& contentKey)
+{
+  if (cipherText.m_suite == CipherSuite::AES_256_GCM) {
+    return aes_256_gcm_decrypt(cipherText.m_content.data(), cipherText.m_content.size(),
+                               contentKey);
+  }
+  if (cipherText.m_suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    return aes_256_gcm_chunked_decrypt(cipherText, contentKey, 0, cipherText.getChunkCount());
+  }
+  GByteArray content{const_cast<guint8*>(cipherText.m_content.data()),
+                     static_cast<guint>(cipherText.m_content.size())};
+  auto result = aes_128_decrypt(&content, contentKey, cipherText.m_plainTextSize);
   return Buffer(result->data, result->len);
 }
 
-void
-ABESupport::init_aes(element_t k, int enc, AES_KEY* key, unsigned char* iv)
+Buffer
+ABESupport::decryptContentRange(const CipherText& cipherText, const Buffer& contentKey,
+                                size_t offset, size_t length)
 {
-  int key_len;
-  unsigned char* key_buf;
+  size_t nChunks = cipherText.getChunkCount();
+  if (nChunks == 0) {
+    BOOST_THROW_EXCEPTION(Error("Content is not chunked"));
+  }
+  size_t chunkSize = cipherText.m_chunkSize;
+  size_t first = offset / chunkSize;
+  if (first >= nChunks) {
+    BOOST_THROW_EXCEPTION(Error("Offset " + std::to_string(offset) + " is past the end"));
+  }
+  // at least the chunk at offset, which tells whether offset is within the plain text
+  length = std::min(length, std::numeric_limits<size_t>::max() - offset);
+  size_t end = length == 0 ? first + 1 :
+               std::min(nChunks, (offset + length - 1) / chunkSize + 1);
 
-  key_len = element_length_in_bytes(k) < 17 ? 17 : element_length_in_bytes(k);
-  key_buf = (unsigned char*) malloc(key_len);
-  element_to_bytes(key_buf, k);
+  Buffer chunks = aes_256_gcm_chunked_decrypt(cipherText, contentKey, first, end - first);
+  size_t begin = offset - first * chunkSize;
+  if (begin > chunks.size()) {
+    BOOST_THROW_EXCEPTION(Error("Offset " + std::to_string(offset) + " is past the end"));
+  }
+  length = std::min(length, chunks.size() - begin);
+  return Buffer(chunks.data() + begin, length);
+}
 
-  if(enc)
-    AES_set_encrypt_key(key_buf + 1, 128, key);
+void
+ABESupport::init_aes(element_t k, int enc, AES_KEY* key, unsigned char* iv)
+{
+  auto keyBuf = deriveAesKey(k);
+  if (enc)
+    AES_set_encrypt_key(keyBuf.data(), 128, key);
   else
-    AES_set_decrypt_key(key_buf + 1, 128, key);
-  free(key_buf);
+    AES_set_decrypt_key(keyBuf.data(), 128, key);
 
   memset(iv, 0, 16);
 }
 
-void
-ABESupport::prependToArray(GByteArray* pt, const guint8 *data, guint dataSize)
+Buffer
+ABESupport::deriveAesKey(element_t k)
 {
-  std::vector<guint8> v(pt->data, pt->data + pt->len);
-  auto it = v.begin();
-  v.insert(it, data, data + dataSize);
-  pt->data = &v[0];
-  pt->len += dataSize;
+  // the key is bytes 1..16 of the element, as in libbswabe
+  Buffer bytes(std::max(element_length_in_bytes(k), 17));
+  element_to_bytes(bytes.data(), k);
+  return Buffer(bytes.data() + 1, 16);
 }
 
-void
-ABESupport::removeFrontFromArray(GByteArray* pt, uint32_t dataSize)
+size_t
+ABESupport::getAes128EncryptedSize(size_t plainTextSize)
 {
-  std::vector<guint8> v(pt->data, pt->data + pt->len);
-  auto it = v.begin();
-  v.erase(it, it + dataSize);
-  pt->data = &v[0];
-  pt->len -= dataSize;
+  /* [zero padding][real length (big endian)][payload], padded out to a
+     multiple of 128 bit (16 byte) blocks */
+  return (plainTextSize + 4 + 15) / 16 * 16;
 }
 
-GByteArray*
-ABESupport::aes_128_encrypt(GByteArray* pt, element_t k)
+GByteArrayPtr
+ABESupport::aes_128_encrypt(const GByteArray* pt, element_t k)
 {
   AES_KEY key;
   unsigned char iv[16];
-  GByteArray* ct;
-  guint8 len[4];
-  guint8 zero;
-
   init_aes(k, 1, &key, iv);
 
-  /* stuff in real length (big endian) before padding */
-  len[0] = (pt->len & 0xff000000)>>24;
-  len[1] = (pt->len & 0xff0000)>>16;
-  len[2] = (pt->len & 0xff00)>>8;
-  len[3] = (pt->len & 0xff)>>0;
-  prependToArray(pt, len, 4);
+  size_t paddedLen = getAes128EncryptedSize(pt->len);
+  std::vector<guint8> padded(paddedLen);
+  size_t headerLen = writeAes128Header(padded.data(), pt->len);
+  std::copy(pt->data, pt->data + pt->len, padded.data() + headerLen);
 
-  /* pad out to multiple of 128 bit (16 byte) blocks */
-  zero = 0;
-  while( pt->len % 16 ) {
-    prependToArray(pt, &zero, 1);
-  }
+  auto ct = makeByteArray();
+  g_byte_array_set_size(ct.get(), paddedLen);
+  AES_cbc_encrypt(padded.data(), ct->data, paddedLen, &key, iv, AES_ENCRYPT);
+  return ct;
+}
 
-  ct = g_byte_array_new();
-  g_byte_array_set_size(ct, pt->len);
+size_t
+ABESupport::prependAes128Encrypted(EncodingBuffer& encoder, const Buffer& aesKey,
+                                   const uint8_t* plainText, size_t plainTextSize)
+{
+  AES_KEY key;
+  unsigned char iv[16] = {0};
+  AES_set_encrypt_key(aesKey.data(), 128, &key);
 
-  AES_cbc_encrypt(pt->data, ct->data, pt->len, &key, iv, AES_ENCRYPT);
+  // the plain text is the only copy; the header goes in front of it and all of it is
+  // encrypted in place
+  size_t paddedLen = getAes128EncryptedSize(plainTextSize);
+  uint8_t header[20];
+  size_t headerLen = writeAes128Header(header, plainTextSize);
+  encoder.prependByteArray(plainText, plainTextSize);
+  encoder.prependByteArray(header, headerLen);
 
-  return ct;
+  AES_cbc_encrypt(encoder.buf(), encoder.buf(), paddedLen, &key, iv, AES_ENCRYPT);
+  return paddedLen;
 }
 
-GByteArray*
-ABESupport::aes_128_decrypt(GByteArray* ct, element_t k, uint32_t outputSize)
+GByteArrayPtr
+ABESupport::aes_128_decrypt(const GByteArray* ct, element_t k, uint32_t outputSize)
 {
-  AES_KEY key;
-  unsigned char iv[16];
-  GByteArray* pt;
+  return aes_128_decrypt(ct, deriveAesKey(k), outputSize);
+}
 
-  init_aes(k, 0, &key, iv);
+GByteArrayPtr
+ABESupport::aes_128_decrypt(const GByteArray* ct, const Buffer& aesKey, uint32_t outputSize)
+{
+  AES_KEY key;
+  unsigned char iv[16] = {0};
+  AES_set_decrypt_key(aesKey.data(), 128, &key);
 
-  pt = g_byte_array_new();
-  g_byte_array_set_size(pt, ct->len);
+  auto pt = makeByteArray();
+  g_byte_array_set_size(pt.get(), ct->len);
 
   AES_cbc_encrypt(ct->data, pt->data, ct->len, &key, iv, AES_DECRYPT);
 
-  g_byte_array_remove_index(pt, 0);
-  g_byte_array_remove_index(pt, 0);
-  g_byte_array_remove_index(pt, 0);
-  g_byte_array_remove_index(pt, 0);
-
-  removeFrontFromArray(pt, pt->len - outputSize);
+  /* the payload is at the end, after the padding and the length */
+  if (outputSize < pt->len) {
+    g_byte_array_remove_range(pt.get(), 0, pt->len - outputSize);
+  }
   return pt;
 }
 
+Buffer
+ABESupport::deriveAes256Key(element_t k)
+{
+  return hkdfFromElement(k, HKDF_INFO, AES_256_GCM_KEY_SIZE);
+}
+
+size_t
+ABESupport::getAes256GcmEncryptedSize(size_t plainTextSize)
+{
+  return AES_256_GCM_NONCE_SIZE + plainTextSize + AES_256_GCM_TAG_SIZE;
+}
+
+Buffer
+ABESupport::aes_256_gcm_encrypt(const uint8_t* plainText, size_t plainTextSize,
+                                const Buffer& aesKey, const Buffer& aad)
+{
+  Buffer result(getAes256GcmEncryptedSize(plainTextSize));
+  uint8_t* data = result.data() + AES_256_GCM_NONCE_SIZE;
+  std::copy(plainText, plainText + plainTextSize, data);
+  random::generateSecureBytes(result.data(), AES_256_GCM_NONCE_SIZE);
+  gcmSeal(aesKey.data(), result.data(), aad.data(), aad.size(),
+          data, plainTextSize, data + plainTextSize);
+  return result;
+}
+
+Buffer
+ABESupport::aes_256_gcm_decrypt(const uint8_t* cipherText, size_t cipherTextSize,
+                                const Buffer& aesKey, const Buffer& aad)
+{
+  if (cipherTextSize < getAes256GcmEncryptedSize(0)) {
+    BOOST_THROW_EXCEPTION(Error("AES-256-GCM cipher text is too short"));
+  }
+  size_t size = cipherTextSize - getAes256GcmEncryptedSize(0);
+  Buffer result(size);
+  gcmOpen(aesKey.data(), cipherText, aad.data(), aad.size(), cipherText + AES_256_GCM_NONCE_SIZE,
+          size, result.data());
+  return result;
+}
+
+size_t
+ABESupport::prependAes256GcmEncrypted(EncodingBuffer& encoder, const Buffer& aesKey,
+                                      const uint8_t* plainText, size_t plainTextSize,
+                                      const Buffer& aad)
+{
+  // nonce and tag are filled in once the plain text is in the buffer
+  uint8_t placeholder[AES_256_GCM_TAG_SIZE] = {0};
+  encoder.prependByteArray(placeholder, AES_256_GCM_TAG_SIZE);
+  encoder.prependByteArray(plainText, plainTextSize);
+  encoder.prependByteArray(placeholder, AES_256_GCM_NONCE_SIZE);
+
+  uint8_t* nonce = encoder.buf();
+  uint8_t* data = nonce + AES_256_GCM_NONCE_SIZE;
+  random::generateSecureBytes(nonce, AES_256_GCM_NONCE_SIZE);
+  gcmSeal(aesKey.data(), nonce, aad.data(), aad.size(), data, plainTextSize, data + plainTextSize);
+  return getAes256GcmEncryptedSize(plainTextSize);
+}
+
+Buffer
+ABESupport::makeSegmentAad(uint64_t segment, bool isLast)
+{
+  // [segment number, big endian][1 if last]
+  Buffer aad(9);
+  for (size_t i = 0; i < 8; i++) {
+    aad[7 - i] = static_cast<uint8_t>(segment >> (8 * i));
+  }
+  aad[8] = isLast ? 1 : 0;
+  return aad;
+}
+
+Buffer
+ABESupport::deriveChunkedKey(element_t k)
+{
+  return hkdfFromElement(k, HKDF_INFO_CHUNKED, AES_256_GCM_KEY_SIZE + AES_256_GCM_NONCE_SIZE);
+}
+
+size_t
+ABESupport::getChunkedEncryptedSize(size_t plainTextSize, size_t chunkSize)
+{
+  // an empty plain text is still one chunk, with a tag
+  size_t nChunks = std::max<size_t>((plainTextSize + chunkSize - 1) / chunkSize, 1);
+  return plainTextSize + nChunks * AES_256_GCM_TAG_SIZE;
+}
+
+size_t
+ABESupport::getChunkCount(size_t encryptedSize, size_t chunkSize)
+{
+  size_t stride = chunkSize + AES_256_GCM_TAG_SIZE;
+  return (encryptedSize + stride - 1) / stride;
+}
+
+Buffer
+ABESupport::aes_256_gcm_chunked_encrypt(const uint8_t* plainText, size_t plainTextSize,
+                                        const Buffer& contentKey, size_t chunkSize)
+{
+  checkChunkedKey(contentKey);
+  if (chunkSize == 0) {
+    BOOST_THROW_EXCEPTION(Error("Chunk size must be positive"));
+  }
+  Buffer result(getChunkedEncryptedSize(plainTextSize, chunkSize));
+  size_t stride = chunkSize + AES_256_GCM_TAG_SIZE;
+  for (size_t offset = 0, out = 0; offset < plainTextSize; offset += chunkSize, out += stride) {
+    size_t size = std::min(chunkSize, plainTextSize - offset);
+    std::copy(plainText + offset, plainText + offset + size, result.data() + out);
+  }
+  sealChunks(contentKey, result.data(), plainTextSize, chunkSize);
+  return result;
+}
+
+Buffer
+ABESupport::aes_256_gcm_chunked_decrypt(const CipherText& cipherText, const Buffer& contentKey,
+                                        size_t first, size_t count)
+{
+  checkChunkedKey(contentKey);
+  if (cipherText.m_suite != CipherSuite::AES_256_GCM_CHUNKED || cipherText.m_chunkSize == 0) {
+    BOOST_THROW_EXCEPTION(Error("Content is not chunked"));
+  }
+  const Buffer& content = cipherText.m_content;
+  size_t chunkSize = cipherText.m_chunkSize;
+  size_t stride = chunkSize + AES_256_GCM_TAG_SIZE;
+  size_t nChunks = cipherText.getChunkCount();
+  if (nChunks == 0 || (content.size() - 1) % stride + 1 < AES_256_GCM_TAG_SIZE) {
+    BOOST_THROW_EXCEPTION(Error("Chunked content is truncated"));
+  }
+  if (first > nChunks || count > nChunks - first) {
+    BOOST_THROW_EXCEPTION(Error("Chunks [" + std::to_string(first) + ", " +
+                                std::to_string(first + count) + ") are out of range"));
+  }
+
+  // every chunk but the last is full
+  size_t lastSize = content.size() - (nChunks - 1) * stride - AES_256_GCM_TAG_SIZE;
+  size_t resultSize = count == 0 ? 0 : (count - 1) * chunkSize +
+                      (first + count == nChunks ? lastSize : chunkSize);
+  Buffer result(resultSize);
+  processInRanges(count, PARALLEL_MIN_CHUNKS,
+                  [&] (size_t begin, size_t end) {
+                    for (size_t i = first + begin; i < first + end; i++) {
+                      Chunk chunk(contentKey, i, i + 1 == nChunks);
+                      size_t size = i + 1 == nChunks ? lastSize : chunkSize;
+                      gcmOpen(chunk.key, chunk.nonce, &chunk.isLast, 1,
+                              content.data() + i * stride, size,
+                              result.data() + (i - first) * chunkSize);
+                    }
+                  });
+  return result;
+}
+
+Buffer
+ABESupport::deriveKey(CipherSuite suite, element_t k)
+{
+  if (suite == CipherSuite::AES_256_GCM) {
+    return deriveAes256Key(k);
+  }
+  if (suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    return deriveChunkedKey(k);
+  }
+  return deriveAesKey(k);
+}
+
+size_t
+ABESupport::getEncryptedSize(CipherSuite suite, size_t plainTextSize)
+{
+  if (suite == CipherSuite::AES_256_GCM) {
+    return getAes256GcmEncryptedSize(plainTextSize);
+  }
+  if (suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    BOOST_THROW_EXCEPTION(Error("Chunked content is not encrypted while encoding"));
+  }
+  return getAes128EncryptedSize(plainTextSize);
+}
+
+size_t
+ABESupport::prependEncrypted(EncodingBuffer& encoder, CipherSuite suite, const Buffer& key,
+                             const uint8_t* plainText, size_t plainTextSize, const Buffer& aad)
+{
+  if (suite == CipherSuite::AES_256_GCM) {
+    return prependAes256GcmEncrypted(encoder, key, plainText, plainTextSize, aad);
+  }
+  if (suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    BOOST_THROW_EXCEPTION(Error("Chunked content is not encrypted while encoding"));
+  }
+  if (!aad.empty()) {
+    BOOST_THROW_EXCEPTION(Error("AES-128-CBC cannot authenticate associated data"));
+  }
+  return prependAes128Encrypted(encoder, key, plainText, plainTextSize);
+}
+
 } // namespace algo
 } // namespace ndnabac
 } // namespace ndn
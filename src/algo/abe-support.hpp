@@ -25,17 +25,61 @@
 #include "public-params.hpp"
 #include "master-key.hpp"
 #include "private-key.hpp"
+#include "decoded-private-key.hpp"
 #include "cipher-text.hpp"
+#include "compiled-policy.hpp"
+#include "pairing.hpp"
+#include "bswabe-ptr.hpp"
+#include "../thread-pool.hpp"
+
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
 
 #include <openssl/aes.h>
 #include <openssl/sha.h>
+#include <openssl/evp.h>
 
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+/**
+ * @brief CP-ABE primitives
+ *
+ * All functions are reentrant and may be called concurrently.  The prepared public
+ * parameters, decoded private keys, and compiled policies they use are only read after
+ * construction, so one instance of each can be shared by every thread; pbc itself keeps
+ * no per-thread state that would call for a separate pairing per thread.
+ */
 class ABESupport
 {
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+public:
+  /**
+   * Smallest number of policy leaves for which encrypt() parallelizes the leaf components.
+   */
+  static const size_t PARALLEL_ENCRYPT_MIN_LEAVES;
+
+  /**
+   * Smallest number of chosen leaves for which decrypt() computes the pairings in parallel.
+   */
+  static const size_t PARALLEL_DECRYPT_MIN_LEAVES;
+
+  /**
+   * Smallest number of chunks that are encrypted or decrypted in parallel.
+   */
+  static const size_t PARALLEL_MIN_CHUNKS;
+
+  /**
+   * Chunk size of encryptChunked() unless specified.
+   */
+  static const size_t DEFAULT_CHUNK_SIZE;
+
 public:
   static void
   setup(PublicParams& pubParams, MasterKey& masterKey);
@@ -47,32 +91,269 @@ public:
    * "foo bar fim 2of3 baf 1of2"
    */
   static PrivateKey
-  prvKeyGen(PublicParams& pubParams, MasterKey& masterKey,
+  prvKeyGen(const PublicParams& pubParams, const MasterKey& masterKey,
             const std::vector<std::string>& attrList);
 
+  /**
+   * @throw CompiledPolicy::Error @p policy cannot be parsed
+   * @throw Error the public parameters are missing
+   */
   static CipherText
   encrypt(const PublicParams& pubParams,
           const std::string& policy, Buffer plaintext);
 
+  /**
+   * @brief Encrypt under a policy that has already been parsed and hashed
+   *
+   * The per-leaf exponentiations of policies with at least PARALLEL_ENCRYPT_MIN_LEAVES
+   * leaves run on a process-wide pool with one worker per hardware thread.
+   * @param suite the content cipher; AES_128_CBC is only needed for peers that cannot
+   *              read AES-256-GCM
+   * @throw Error the public parameters are missing
+   */
+  static CipherText
+  encrypt(const PublicParams& pubParams,
+          const CompiledPolicy& policy, Buffer plaintext,
+          CipherSuite suite = CipherSuite::AES_256_GCM);
+
+  /**
+   * @brief ABE-encrypt a fresh content key only, leaving @p plainText to the encoder
+   *
+   * The returned cipher text encrypts @p plainText while it is being encoded, straight
+   * into the encoding buffer (see CipherText::makeDataContent), so the plain text is
+   * copied once.  @p plainText must stay valid and unchanged until then.
+   * @throw Error the public parameters are missing
+   */
+  static CipherText
+  encryptDeferred(const PublicParams& pubParams, const CompiledPolicy& policy,
+                  const uint8_t* plainText, size_t plainTextSize);
+
+  /**
+   * @brief Encrypt @p plainText with CipherSuite::AES_256_GCM_CHUNKED
+   *
+   * Every chunk of @p chunkSize bytes can be decrypted on its own, see decryptContentKey
+   * and aes_256_gcm_chunked_decrypt.  From PARALLEL_MIN_CHUNKS chunks on, the chunks are
+   * encrypted in parallel.
+   * @throw Error the public parameters are missing or @p chunkSize is 0
+   */
+  static CipherText
+  encryptChunked(const PublicParams& pubParams, const CompiledPolicy& policy,
+                 const uint8_t* plainText, size_t plainTextSize,
+                 size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+  /**
+   * @brief Encrypt each of @p plainTexts under @p policy on the workers of @p pool
+   * @return one ciphertext per plaintext, in the same order
+   * @throw Error the public parameters are missing
+   */
+  static std::vector<CipherText>
+  encryptBatch(const PublicParams& pubParams, const CompiledPolicy& policy,
+               const std::vector<Buffer>& plainTexts, ThreadPool& pool);
+
+  /**
+   * @brief Parse @p policy once, then encrypt each of @p plainTexts under it
+   * @throw CompiledPolicy::Error @p policy cannot be parsed
+   * @throw Error the public parameters are missing
+   */
+  static std::vector<CipherText>
+  encryptBatch(const PublicParams& pubParams, const std::string& policy,
+               const std::vector<Buffer>& plainTexts, ThreadPool& pool);
+
   static Buffer
   decrypt(const PublicParams& pubParams,
-          const PrivateKey& prvKey, CipherText cipherText);
+          const PrivateKey& prvKey, const CipherText& cipherText);
 
-public:
-  static void
-  prependToArray(GByteArray* pt, const guint8 *data, guint dataSize);
+  /**
+   * Decrypt with a key that has already been decoded, e.g., one kept in a key cache.
+   *
+   * Every threshold gate uses the k satisfied children that need the fewest leaves.  The
+   * pairings of the chosen leaves are evaluated as one product of pairings (see
+   * Pairing::multi_pairing), split over several threads from PARALLEL_DECRYPT_MIN_LEAVES
+   * leaves on.
+   * @throw Error the attributes in @p prvKey do not satisfy the policy, or the content
+   *        fails authentication
+   * @throw BswabeCodec::Error @p cipherText is malformed
+   */
+  static Buffer
+  decrypt(const DecodedPrivateKey& prvKey, const CipherText& cipherText);
 
-  static void
-  removeFrontFromArray(GByteArray* pt, uint32_t dataSize);
+  /**
+   * @brief Run the ABE decryption of @p cipherText only, for the content key of its suite
+   *
+   * With the key of a chunked cipher text, any range of chunks can then be decrypted
+   * without repeating the pairings.
+   * @throw Error the attributes in @p prvKey do not satisfy the policy
+   */
+  static Buffer
+  decryptContentKey(const DecodedPrivateKey& prvKey, const CipherText& cipherText);
 
-  static GByteArray*
-  aes_128_encrypt(GByteArray* pt, element_t k);
+  /**
+   * @brief Decrypt the content of @p cipherText with a content key recovered before, e.g.,
+   *        one cached by CK name
+   *
+   * AES-128-CBC content needs the plain text size in @p cipherText.
+   * @throw Error the content fails authentication
+   */
+  static Buffer
+  decryptContent(const CipherText& cipherText, const Buffer& contentKey);
 
-  static GByteArray*
-  aes_128_decrypt(GByteArray* ct, element_t k, uint32_t outputSize);
+  /**
+   * @brief Decrypt bytes [@p offset, @p offset + @p length) of the plain text of a chunked
+   *        cipher text, cut short at its end
+   *
+   * Only the chunks that hold the range are decrypted, in parallel from
+   * PARALLEL_MIN_CHUNKS chunks on.
+   * @param contentKey as returned by decryptContentKey
+   * @throw Error the content is not chunked, @p offset is past its end, or a chunk fails
+   *        authentication
+   */
+  static Buffer
+  decryptContentRange(const CipherText& cipherText, const Buffer& contentKey,
+                      size_t offset, size_t length);
+
+public:
+  static GByteArrayPtr
+  aes_128_encrypt(const GByteArray* pt, element_t k);
+
+  static GByteArrayPtr
+  aes_128_decrypt(const GByteArray* ct, element_t k, uint32_t outputSize);
+
+  static GByteArrayPtr
+  aes_128_decrypt(const GByteArray* ct, const Buffer& aesKey, uint32_t outputSize);
 
   static void
   init_aes(element_t k, int enc, AES_KEY* key, unsigned char* iv);
+
+  /**
+   * @brief The AES-128 key that aes_128_encrypt and aes_128_decrypt derive from @p k
+   */
+  static Buffer
+  deriveAesKey(element_t k);
+
+  /**
+   * @return the size of the aes_128_encrypt output for @p plainTextSize bytes
+   */
+  static size_t
+  getAes128EncryptedSize(size_t plainTextSize);
+
+  /**
+   * @brief Prepend to @p encoder what aes_128_encrypt would output for @p plainText
+   *
+   * The padded plain text is written into the encoding buffer and encrypted in place.
+   * @return the number of bytes prepended, getAes128EncryptedSize(@p plainTextSize)
+   */
+  static size_t
+  prependAes128Encrypted(EncodingBuffer& encoder, const Buffer& aesKey,
+                         const uint8_t* plainText, size_t plainTextSize);
+
+  /**
+   * @brief The AES-256 key derived from @p k with HKDF-SHA256
+   */
+  static Buffer
+  deriveAes256Key(element_t k);
+
+  /**
+   * @return the size of the aes_256_gcm_encrypt output for @p plainTextSize bytes
+   */
+  static size_t
+  getAes256GcmEncryptedSize(size_t plainTextSize);
+
+  /**
+   * @brief Encrypt @p plainText with a random nonce
+   * @param aad associated data, authenticated but not included in the output
+   * @return the nonce, the cipher text and the tag
+   */
+  static Buffer
+  aes_256_gcm_encrypt(const uint8_t* plainText, size_t plainTextSize, const Buffer& aesKey,
+                      const Buffer& aad = Buffer());
+
+  /**
+   * @param aad the associated data given on encryption
+   * @throw Error @p cipherText is too short or fails authentication
+   */
+  static Buffer
+  aes_256_gcm_decrypt(const uint8_t* cipherText, size_t cipherTextSize, const Buffer& aesKey,
+                      const Buffer& aad = Buffer());
+
+  /**
+   * @brief Prepend to @p encoder what aes_256_gcm_encrypt would output for @p plainText
+   *
+   * The plain text is written into the encoding buffer and encrypted in place.
+   * @return the number of bytes prepended, getAes256GcmEncryptedSize(@p plainTextSize)
+   */
+  static size_t
+  prependAes256GcmEncrypted(EncodingBuffer& encoder, const Buffer& aesKey,
+                            const uint8_t* plainText, size_t plainTextSize,
+                            const Buffer& aad = Buffer());
+
+  /**
+   * @brief The AES-256-GCM associated data of segment @p segment of a segmented object
+   *
+   * All segments share one content key, so the segment number and a flag for the last
+   * segment are authenticated with each of them, like the chunks of chunked content.
+   * A reordered, duplicated or truncated object then fails authentication.
+   */
+  static Buffer
+  makeSegmentAad(uint64_t segment, bool isLast);
+
+  /**
+   * @brief The AES-256 key and the 96-bit nonce base of chunked content, derived from @p k
+   *        with HKDF-SHA256
+   */
+  static Buffer
+  deriveChunkedKey(element_t k);
+
+  /**
+   * @return the size of chunked content for @p plainTextSize bytes
+   */
+  static size_t
+  getChunkedEncryptedSize(size_t plainTextSize, size_t chunkSize);
+
+  /**
+   * @return the number of chunks in @p encryptedSize bytes of chunked content
+   */
+  static size_t
+  getChunkCount(size_t encryptedSize, size_t chunkSize);
+
+  /**
+   * @param contentKey as returned by deriveChunkedKey
+   */
+  static Buffer
+  aes_256_gcm_chunked_encrypt(const uint8_t* plainText, size_t plainTextSize,
+                              const Buffer& contentKey, size_t chunkSize);
+
+  /**
+   * @brief Decrypt chunks [@p first, @p first + @p count) of a chunked cipher text
+   *
+   * From PARALLEL_MIN_CHUNKS chunks on, the chunks are decrypted in parallel.
+   * @param contentKey as returned by decryptContentKey
+   * @throw Error the content is not chunked, the range is out of bounds, or a chunk
+   *        fails authentication
+   */
+  static Buffer
+  aes_256_gcm_chunked_decrypt(const CipherText& cipherText, const Buffer& contentKey,
+                              size_t first, size_t count);
+
+  /**
+   * @brief The content key of @p suite derived from @p k
+   */
+  static Buffer
+  deriveKey(CipherSuite suite, element_t k);
+
+  /**
+   * @throw Error @p suite is AES_256_GCM_CHUNKED, which is not encrypted while encoding
+   */
+  static size_t
+  getEncryptedSize(CipherSuite suite, size_t plainTextSize);
+
+  /**
+   * @param aad associated data, AES_256_GCM only
+   * @throw Error @p suite is AES_256_GCM_CHUNKED, or @p aad is given for AES_128_CBC
+   */
+  static size_t
+  prependEncrypted(EncodingBuffer& encoder, CipherSuite suite, const Buffer& key,
+                   const uint8_t* plainText, size_t plainTextSize,
+                   const Buffer& aad = Buffer());
 };
 
 } // namespace algo
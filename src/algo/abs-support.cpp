@@ -19,6 +19,7 @@
  */
 
 #include "abs-support.hpp"
+#include "abe-support.hpp"
 #include "pairing.hpp"
 #include <ndn-cxx/util/logger.hpp>
 #include <openssl/evp.h>
@@ -34,40 +35,16 @@ NDN_LOG_INIT(ndnabac.ABESupport);
 void
 ABSSupport::setup(PublicParams& pubParams, MasterKey& masterKey)
 {
-  bswabe_pub_t* pub;
-  bswabe_msk_t* msk;
-  bswabe_setup(&pub, &msk);
-
-  pubParams.m_pub = bswabe_pub_serialize(pub);
-  masterKey.m_msk = bswabe_msk_serialize(msk);
+  ABESupport::setup(pubParams, masterKey);
 }
 
 PrivateKey
 ABSSupport::prvKeyGen(const PublicParams& pubParams, MasterKey& masterKey,
                       const std::vector<std::string>& attrList)
 {
-  // change list<string> to char**
-  char** attrs = new char*[attrList.size() + 1];
-  for (size_t i = 0; i < attrList.size(); i++) {
-    char *cstr = new char[attrList[i].length() + 1];
-    std::strcpy(cstr, attrList[i].c_str());
-    cstr[attrList[i].length()] = 0;
-    attrs[i] = cstr;
-  }
-  attrs[attrList.size()] = 0;
-
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
-  bswabe_msk_t* msk = bswabe_msk_unserialize(pub, masterKey.m_msk, 0);
-  bswabe_prv_t* prv = bswabe_keygen(pub, msk, attrs);
-
-  PrivateKey privateKey;
-  privateKey.m_prv = bswabe_prv_serialize(prv);
-
-/*  for (size_t i = 0; i < attrList.size(); i++) {
-    delete [] attrs[i];
-  }
-  delete [] attrs; */
-  return privateKey;
+  // signing keys have the same form as decryption keys; share the fixed-base tables
+  // and the attribute hash cache with ABESupport
+  return ABESupport::prvKeyGen(pubParams, masterKey, attrList);
 }
 
 SignedMessage
@@ -76,19 +53,16 @@ ABSSupport::signs(const PublicParams& pubParams, PrivateKey& signingKey,
 {
   //unique_ptr<RNG> PRNG = nullptr;
   //unique_ptr<std::string> y = nullptr;
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
-  bswabe_prv_t* prv = bswabe_prv_unserialize(pub, signingKey.m_prv, 0);
-  
-  char *policyCharArray = new char[policy.length() + 1];
-  strcpy(policyCharArray, policy.c_str());
+  BswabePubPtr pubHandle(bswabe_pub_unserialize(pubParams.m_pub.get(), 0));
+  bswabe_pub_t* pub = pubHandle.get();
+  BswabePrvPtr prv(bswabe_prv_unserialize(pub, signingKey.m_prv.get(), 0));
+  std::vector<char> policyCharArray(policy.begin(), policy.end());
+  policyCharArray.push_back('\0');
 
   element_t m;
-  bswabe_sgn_t* sgn = bswabe_sign(pub, prv, m, policyCharArray);
+  BswabeSgnPtr sgn(bswabe_sign(pub, prv.get(), m, policyCharArray.data()));
   SignedMessage result;
-  result.m_sgn = bswabe_sgn_serialize(sgn);
-  bswabe_sgn_free(sgn);
-  delete [] policyCharArray;
-
+  result.m_sgn.reset(bswabe_sgn_serialize(sgn.get()));
   return result;
 
 }
@@ -98,11 +72,10 @@ ABSSupport::verification(const PublicParams& pubParams, SignedMessage signedMess
                          const std::string& policy, const std::string& signs )
 {
   bool answer = 0;
-  bswabe_pub_t* pub = bswabe_pub_unserialize(pubParams.m_pub, 0);
+  BswabePubPtr pubHandle(bswabe_pub_unserialize(pubParams.m_pub.get(), 0));
+  bswabe_pub_t* pub = pubHandle.get();
   element_t m;
-  char *policyCharArray = new char[policy.length() + 1];
-  strcpy(policyCharArray, policy.c_str());
-  bswabe_sgn_t* sgn = bswabe_sgn_unserialize(pub, signedMessage.m_sgn, 0);
+  BswabeSgnPtr sgn(bswabe_sgn_unserialize(pub, signedMessage.m_sgn.get(), 0));
 
   answer = ((m, sgn, signedMessage.m_sgn->len) == 1);
   if(!answer) {
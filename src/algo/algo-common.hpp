@@ -30,11 +30,4 @@
 #include <bswabe.h>
 #include <openssl/sha.h>
 
-class RNG;
-class ZP;
-class G;
-class G1;
-class G2;
-class GT;
-
 #endif // NDNABAC_ALGO_COMMON_HPP
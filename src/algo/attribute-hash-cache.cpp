@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "attribute-hash-cache.hpp"
+#include "bswabe-codec.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+const size_t AttributeHashCache::DEFAULT_CAPACITY = 8192;
+
+HashedAttribute::HashedAttribute(shared_ptr<const PreparedPublicParams> pub,
+                                 const std::string& attr)
+  : m_pub(std::move(pub))
+{
+  element_init_G2(m_element, m_pub->pairing.get());
+  BswabeCodec::hashToElement(m_element, attr);
+}
+
+HashedAttribute::~HashedAttribute()
+{
+  element_clear(m_element);
+}
+
+AttributeHashCache&
+AttributeHashCache::getInstance()
+{
+  static AttributeHashCache instance;
+  return instance;
+}
+
+AttributeHashCache::AttributeHashCache(size_t capacity)
+  : m_entries(capacity)
+  , m_nHits(0)
+  , m_nMisses(0)
+{
+}
+
+shared_ptr<const HashedAttribute>
+AttributeHashCache::get(const shared_ptr<const PreparedPublicParams>& pub, const std::string& attr)
+{
+  Key key(pub.get(), attr);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto entry = m_entries.find(key);
+    if (entry != nullptr) {
+      m_nHits++;
+      return *entry;
+    }
+  }
+
+  // hash outside the lock; a concurrent miss on the same attribute just hashes twice
+  m_nMisses++;
+  auto hashed = make_shared<const HashedAttribute>(pub, attr);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.insert(key, hashed);
+  return hashed;
+}
+
+void
+AttributeHashCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+}
+
+size_t
+AttributeHashCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_ATTRIBUTE_HASH_CACHE_HPP
+#define NDNABAC_ALGO_ATTRIBUTE_HASH_CACHE_HPP
+
+#include "algo-common.hpp"
+#include "prepared-params.hpp"
+#include "../lru-cache.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief An attribute string hashed into the pairing group, as in libbswabe
+ *
+ * The element is in G2, which is the same group as G1 for the type A pairing
+ * used by libbswabe.
+ */
+class HashedAttribute : noncopyable
+{
+public:
+  HashedAttribute(shared_ptr<const PreparedPublicParams> pub, const std::string& attr);
+
+  ~HashedAttribute();
+
+  element_ptr
+  get() const
+  {
+    return const_cast<element_ptr>(m_element);
+  }
+
+private:
+  // the element lives in this pairing
+  shared_ptr<const PreparedPublicParams> m_pub;
+  element_t m_element;
+};
+
+/**
+ * @brief Process-wide, bounded cache of hashed attributes
+ *
+ * Hashing to the curve (SHA-1 plus element_from_hash) is done for every policy leaf
+ * on encryption and every attribute on key generation, while the attribute universe
+ * is small and repeats constantly.  All methods are thread-safe.
+ */
+class AttributeHashCache : noncopyable
+{
+public:
+  static AttributeHashCache&
+  getInstance();
+
+  explicit
+  AttributeHashCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * @brief Get @p attr hashed with @p pub, computing it on a miss
+   */
+  shared_ptr<const HashedAttribute>
+  get(const shared_ptr<const PreparedPublicParams>& pub, const std::string& attr);
+
+  void
+  clear();
+
+  size_t
+  size() const;
+
+  uint64_t
+  getHitCount() const
+  {
+    return m_nHits;
+  }
+
+  uint64_t
+  getMissCount() const
+  {
+    return m_nMisses;
+  }
+
+public:
+  static const size_t DEFAULT_CAPACITY;
+
+private:
+  using Key = std::pair<const PreparedPublicParams*, std::string>;
+
+  mutable std::mutex m_mutex;
+  // entries keep their parameters alive, so the pointer in the key is never reused
+  LruCache<Key, shared_ptr<const HashedAttribute>> m_entries;
+  std::atomic<uint64_t> m_nHits;
+  std::atomic<uint64_t> m_nMisses;
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_ATTRIBUTE_HASH_CACHE_HPP
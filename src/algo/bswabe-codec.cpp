@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "bswabe-codec.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+void
+BswabeCodec::appendUint32(GByteArray* buf, uint32_t value)
+{
+  guint8 bytes[4] = {static_cast<guint8>(value >> 24), static_cast<guint8>(value >> 16),
+                     static_cast<guint8>(value >> 8), static_cast<guint8>(value)};
+  g_byte_array_append(buf, bytes, 4);
+}
+
+void
+BswabeCodec::appendString(GByteArray* buf, const std::string& str)
+{
+  g_byte_array_append(buf, reinterpret_cast<const guint8*>(str.c_str()),
+                      static_cast<guint>(str.size() + 1));
+}
+
+void
+BswabeCodec::appendElement(GByteArray* buf, element_t e)
+{
+  int len = element_length_in_bytes(e);
+  appendUint32(buf, static_cast<uint32_t>(len));
+
+  guint oldLen = buf->len;
+  g_byte_array_set_size(buf, oldLen + len);
+  element_to_bytes(buf->data + oldLen, e);
+}
+
+uint32_t
+BswabeCodec::readUint32(const GByteArray* buf, size_t& offset)
+{
+  if (offset + 4 > buf->len) {
+    BOOST_THROW_EXCEPTION(Error("Truncated integer"));
+  }
+  const guint8* p = buf->data + offset;
+  offset += 4;
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+std::string
+BswabeCodec::readString(const GByteArray* buf, size_t& offset)
+{
+  if (offset >= buf->len) {
+    BOOST_THROW_EXCEPTION(Error("Truncated string"));
+  }
+  const guint8* begin = buf->data + offset;
+  const guint8* last = buf->data + buf->len;
+  const guint8* end = std::find(begin, last, 0);
+  if (end == last) {
+    BOOST_THROW_EXCEPTION(Error("Unterminated string"));
+  }
+  offset += end - begin + 1;
+  return std::string(begin, end);
+}
+
+void
+BswabeCodec::readElement(const GByteArray* buf, size_t& offset, element_t e)
+{
+  uint32_t len = readUint32(buf, offset);
+  if (offset + len > buf->len || len != static_cast<uint32_t>(element_length_in_bytes(e))) {
+    BOOST_THROW_EXCEPTION(Error("Malformed element"));
+  }
+  element_from_bytes(e, buf->data + offset);
+  offset += len;
+}
+
+void
+BswabeCodec::hashToElement(element_t e, const std::string& str)
+{
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1(reinterpret_cast<const unsigned char*>(str.data()), str.size(), digest);
+  element_from_hash(e, digest, SHA_DIGEST_LENGTH);
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_BSWABE_CODEC_HPP
+#define NDNABAC_ALGO_BSWABE_CODEC_HPP
+
+#include "algo-common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief Reads and writes pbc elements in the libbswabe serialization format
+ *
+ * This lets the CP-ABE code work on pbc elements directly while PublicParams,
+ * MasterKey, PrivateKey and CipherText keep the wire format produced by libbswabe:
+ * big-endian uint32 counters, NUL-terminated strings and length-prefixed elements.
+ */
+class BswabeCodec
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+public:
+  static void
+  appendUint32(GByteArray* buf, uint32_t value);
+
+  static void
+  appendString(GByteArray* buf, const std::string& str);
+
+  static void
+  appendElement(GByteArray* buf, element_t e);
+
+  /**
+   * @throw Error the buffer ends before the value
+   */
+  static uint32_t
+  readUint32(const GByteArray* buf, size_t& offset);
+
+  static std::string
+  readString(const GByteArray* buf, size_t& offset);
+
+  /**
+   * @param e an element already initialized in the expected group
+   */
+  static void
+  readElement(const GByteArray* buf, size_t& offset, element_t e);
+
+  /**
+   * @brief Map @p str into the group of @p e the way libbswabe does (SHA-1, then
+   *        element_from_hash), so attribute hashes agree with bswabe_dec.
+   */
+  static void
+  hashToElement(element_t e, const std::string& str);
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_BSWABE_CODEC_HPP
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_BSWABE_PTR_HPP
+#define NDNABAC_ALGO_BSWABE_PTR_HPP
+
+#include "algo-common.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief Owners for the GLib byte arrays and bswabe objects used in src/algo
+ *
+ * Every byte array or bswabe object we allocate goes into one of these right away,
+ * so it is freed on every path, exceptions included.  They are move-only; copying
+ * the contents of a byte array is explicit through copyByteArray().
+ */
+struct GByteArrayDeleter
+{
+  void
+  operator()(GByteArray* array) const
+  {
+    g_byte_array_free(array, 1);
+  }
+};
+
+using GByteArrayPtr = unique_ptr<GByteArray, GByteArrayDeleter>;
+
+inline GByteArrayPtr
+makeByteArray(const uint8_t* data = nullptr, size_t size = 0)
+{
+  GByteArrayPtr array(g_byte_array_new());
+  if (size > 0) {
+    g_byte_array_append(array.get(), data, static_cast<guint>(size));
+  }
+  return array;
+}
+
+/**
+ * @return a new array with the contents of @p array, or nullptr if @p array is nullptr
+ */
+inline GByteArrayPtr
+copyByteArray(const GByteArray* array)
+{
+  if (array == nullptr) {
+    return nullptr;
+  }
+  return makeByteArray(array->data, array->len);
+}
+
+/**
+ * @return whether @p array holds the same bytes as @p buffer
+ */
+inline bool
+hasContents(const GByteArray* array, const Buffer& buffer)
+{
+  return array->len == buffer.size() && std::equal(buffer.begin(), buffer.end(), array->data);
+}
+
+template<typename T, void (*FREE)(T*)>
+struct BswabeDeleter
+{
+  void
+  operator()(T* object) const
+  {
+    FREE(object);
+  }
+};
+
+using BswabePubPtr = unique_ptr<bswabe_pub_t, BswabeDeleter<bswabe_pub_t, &bswabe_pub_free>>;
+using BswabeMskPtr = unique_ptr<bswabe_msk_t, BswabeDeleter<bswabe_msk_t, &bswabe_msk_free>>;
+using BswabePrvPtr = unique_ptr<bswabe_prv_t, BswabeDeleter<bswabe_prv_t, &bswabe_prv_free>>;
+using BswabeCphPtr = unique_ptr<bswabe_cph_t, BswabeDeleter<bswabe_cph_t, &bswabe_cph_free>>;
+using BswabeSgnPtr = unique_ptr<bswabe_sgn_t, BswabeDeleter<bswabe_sgn_t, &bswabe_sgn_free>>;
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_BSWABE_PTR_HPP
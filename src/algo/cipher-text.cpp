@@ -19,12 +19,97 @@
  */
 
 #include "cipher-text.hpp"
+#include "abe-support.hpp"
+
 #include <ndn-cxx/util/concepts.hpp>
 
+#include <limits>
+
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+std::ostream&
+operator<<(std::ostream& os, CipherSuite suite)
+{
+  switch (suite) {
+  case CipherSuite::AES_128_CBC:
+    return os << "AES-128-CBC";
+  case CipherSuite::AES_256_GCM:
+    return os << "AES-256-GCM";
+  case CipherSuite::AES_256_GCM_CHUNKED:
+    return os << "AES-256-GCM-CHUNKED";
+  }
+  return os << static_cast<int>(suite);
+}
+
+static CipherSuite
+readCipherSuite(const Block& block)
+{
+  auto suite = readNonNegativeInteger(block);
+  switch (suite) {
+  case static_cast<uint64_t>(CipherSuite::AES_128_CBC):
+  case static_cast<uint64_t>(CipherSuite::AES_256_GCM):
+  case static_cast<uint64_t>(CipherSuite::AES_256_GCM_CHUNKED):
+    return static_cast<CipherSuite>(suite);
+  default:
+    BOOST_THROW_EXCEPTION(tlv::Error("Unsupported cipher suite " + std::to_string(suite)));
+  }
+}
+
+CipherText::CipherText(const CipherText& other)
+  : m_cph(copyByteArray(other.m_cph.get()))
+  , m_content(other.m_content)
+  , m_plainTextSize(other.m_plainTextSize)
+  , m_suite(other.m_suite)
+  , m_chunkSize(other.m_chunkSize)
+  , m_wire(other.m_wire)
+{
+  if (other.m_pendingPlainText != nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Cannot copy a cipher text whose content is not encrypted yet"));
+  }
+}
+
+CipherText::CipherText(CipherText&& other)
+  : m_cph(std::move(other.m_cph))
+  , m_content(std::move(other.m_content))
+  , m_plainTextSize(other.m_plainTextSize)
+  , m_suite(other.m_suite)
+  , m_chunkSize(other.m_chunkSize)
+  , m_pendingPlainText(other.m_pendingPlainText)
+  , m_pendingKey(std::move(other.m_pendingKey))
+  , m_pendingAad(std::move(other.m_pendingAad))
+  , m_wire(std::move(other.m_wire))
+{
+  // the moved-from object must not encode the plain text under a key it no longer has
+  other.m_pendingPlainText = nullptr;
+}
+
+CipherText&
+CipherText::operator=(const CipherText& other)
+{
+  return *this = CipherText(other);
+}
+
+CipherText&
+CipherText::operator=(CipherText&& other)
+{
+  if (this == &other) {
+    return *this;
+  }
+  m_cph = std::move(other.m_cph);
+  m_content = std::move(other.m_content);
+  m_plainTextSize = other.m_plainTextSize;
+  m_suite = other.m_suite;
+  m_chunkSize = other.m_chunkSize;
+  m_pendingPlainText = other.m_pendingPlainText;
+  other.m_pendingPlainText = nullptr;
+  m_pendingKey = std::move(other.m_pendingKey);
+  m_pendingAad = std::move(other.m_pendingAad);
+  m_wire = std::move(other.m_wire);
+  return *this;
+}
+
 template<encoding::Tag TAG>
 size_t
 CipherText::wireEncode(EncodingImpl<TAG>& encoder) const
@@ -32,17 +117,16 @@ CipherText::wireEncode(EncodingImpl<TAG>& encoder) const
   size_t totalLength = 0;
 
   // encrypted symmetric key
-  Buffer aesKeyBuf(m_cph->data, m_cph->len);
-  totalLength += encoder.prependByteArrayBlock(TLV_EncryptedAesKey,
-                                               aesKeyBuf.data(), aesKeyBuf.size());
+  totalLength += encoder.prependByteArrayBlock(TLV_EncryptedAesKey, m_cph->data, m_cph->len);
 
   // encrypted content
-  totalLength += encoder.prependByteArrayBlock(TLV_EncryptedContent,
-                                               m_content.data(), m_content.size());
+  totalLength += prependEncryptedContent(encoder);
 
   // plain text length
   totalLength += prependNonNegativeIntegerBlock(encoder, TLV_PlainTextSize, m_plainTextSize);
 
+  totalLength += prependCipherSuite(encoder);
+
   totalLength += encoder.prependVarNumber(totalLength);
   totalLength += encoder.prependVarNumber(tlv::Content);
 
@@ -79,9 +163,12 @@ CipherText::wireDecode(const Block& wire)
 
   Block::element_const_iterator it = m_wire.elements_begin();
 
+  // cipher suite, absent from AES-128-CBC cipher texts
+  decodeCipherSuite(it, m_wire.elements_end());
+
   // plain text length
   if (it != m_wire.elements_end() && it->type() == TLV_PlainTextSize) {
-    this->m_plainTextSize = static_cast<uint8_t>(readNonNegativeInteger(*it));
+    this->m_plainTextSize = static_cast<uint32_t>(readNonNegativeInteger(*it));
     it++;
   }
 
@@ -95,9 +182,7 @@ CipherText::wireDecode(const Block& wire)
 
   // encrypted symmetric key
   if (it != m_wire.elements_end() && it->type() == TLV_EncryptedAesKey) {
-    Buffer cphBuffer(it->value(), it->value_size());
-    m_cph = g_byte_array_new();
-    g_byte_array_append(m_cph, cphBuffer.data(), static_cast<guint>(cphBuffer.size()));
+    m_cph = makeByteArray(it->value(), it->value_size());
     it++;
   }
   else
@@ -108,23 +193,188 @@ CipherText::wireDecode(const Block& wire)
     BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure after decoding the block"));
 }
 
+size_t
+CipherText::prependEncryptedContent(EncodingImpl<encoding::EstimatorTag>& estimator) const
+{
+  if (m_pendingPlainText == nullptr) {
+    return estimator.prependByteArrayBlock(TLV_EncryptedContent, m_content.data(), m_content.size());
+  }
+
+  size_t totalLength = ABESupport::getEncryptedSize(m_suite, m_plainTextSize);
+  totalLength += estimator.prependVarNumber(totalLength);
+  totalLength += estimator.prependVarNumber(TLV_EncryptedContent);
+  return totalLength;
+}
+
+size_t
+CipherText::prependEncryptedContent(EncodingImpl<encoding::EncoderTag>& encoder) const
+{
+  if (m_pendingPlainText == nullptr) {
+    return encoder.prependByteArrayBlock(TLV_EncryptedContent, m_content.data(), m_content.size());
+  }
+
+  size_t totalLength = ABESupport::prependEncrypted(encoder, m_suite, m_pendingKey,
+                                                    m_pendingPlainText, m_plainTextSize,
+                                                    m_pendingAad);
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(TLV_EncryptedContent);
+  return totalLength;
+}
+
+template<encoding::Tag TAG>
+size_t
+CipherText::prependCipherSuite(EncodingImpl<TAG>& encoder) const
+{
+  // left out for AES-128-CBC, so that those cipher texts stay readable by old consumers
+  if (m_suite == CipherSuite::AES_128_CBC) {
+    return 0;
+  }
+  size_t totalLength = 0;
+  if (m_suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    totalLength += prependNonNegativeIntegerBlock(encoder, TLV_ChunkSize, m_chunkSize);
+  }
+  totalLength += prependNonNegativeIntegerBlock(encoder, TLV_CipherSuite,
+                                                static_cast<uint64_t>(m_suite));
+  return totalLength;
+}
+
+void
+CipherText::decodeCipherSuite(Block::element_const_iterator& it, Block::element_const_iterator end)
+{
+  m_suite = CipherSuite::AES_128_CBC;
+  m_chunkSize = 0;
+  if (it == end || it->type() != TLV_CipherSuite) {
+    return;
+  }
+  m_suite = readCipherSuite(*it);
+  it++;
+
+  if (m_suite == CipherSuite::AES_256_GCM_CHUNKED) {
+    if (it == end || it->type() != TLV_ChunkSize)
+      BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure when decoding chunk size"));
+    auto chunkSize = readNonNegativeInteger(*it);
+    if (chunkSize == 0 || chunkSize > std::numeric_limits<uint32_t>::max())
+      BOOST_THROW_EXCEPTION(tlv::Error("Invalid chunk size " + std::to_string(chunkSize)));
+    m_chunkSize = static_cast<uint32_t>(chunkSize);
+    it++;
+  }
+}
+
+size_t
+CipherText::getChunkCount() const
+{
+  if (m_suite != CipherSuite::AES_256_GCM_CHUNKED || m_chunkSize == 0) {
+    return 0;
+  }
+  return ABESupport::getChunkCount(m_content.size(), m_chunkSize);
+}
+
+template<encoding::Tag TAG>
+size_t
+CipherText::prependDataContent(EncodingImpl<TAG>& encoder, const Name& ckName) const
+{
+  size_t totalLength = 0;
+  totalLength += ckName.wireEncode(encoder);
+  totalLength += prependEncryptedContent(encoder);
+  totalLength += prependCipherSuite(encoder);
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::Content);
+  return totalLength;
+}
+
+Block
+CipherText::makeDataContent() const
+{
+  EncodingEstimator estimator;
+  EncodingBuffer buffer(prependEncryptedContent(estimator), 0);
+  prependEncryptedContent(buffer);
+  return buffer.block();
+}
+
 Block
-CipherText::makeDataContent()
+CipherText::makeDataContent(const Name& ckName) const
+{
+  EncodingEstimator estimator;
+  EncodingBuffer buffer(prependDataContent(estimator, ckName), 0);
+  prependDataContent(buffer, ckName);
+  return buffer.block();
+}
+
+Name
+CipherText::wireDecodeDataContent(const Block& content)
+{
+  if (content.type() != tlv::Content)
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV type when decoding Data content"));
+
+  content.parse();
+  Block::element_const_iterator it = content.elements_begin();
+
+  decodeCipherSuite(it, content.elements_end());
+
+  if (it != content.elements_end() && it->type() == TLV_EncryptedContent) {
+    this->m_content = Buffer(it->value(), it->value_size());
+    it++;
+  }
+  else
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure when decoding encrypted content"));
+
+  if (it == content.elements_end() || it->type() != tlv::Name)
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure when decoding CK name"));
+  Name ckName(*it);
+  it++;
+
+  if (it != content.elements_end())
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure after decoding the block"));
+  return ckName;
+}
+
+template<encoding::Tag TAG>
+size_t
+CipherText::prependCKContent(EncodingImpl<TAG>& encoder) const
 {
-  auto encryptedBlock = makeBinaryBlock(TLV_EncryptedContent,
-                                        m_content.data(), m_content.size());
-  return encryptedBlock;
+  size_t totalLength = 0;
+  totalLength += prependNonNegativeIntegerBlock(encoder, TLV_PlainTextSize, m_plainTextSize);
+  totalLength += encoder.prependByteArrayBlock(TLV_EncryptedAesKey, m_cph->data, m_cph->len);
+  totalLength += prependCipherSuite(encoder);
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::Content);
+  return totalLength;
 }
 
 Block
-CipherText::makeCKContent()
-{
-  auto ckBlock = makeEmptyBlock(tlv::Content);
-  Buffer aesKeyBuf(m_cph->data, m_cph->len);
-  ckBlock.push_back(makeBinaryBlock(TLV_EncryptedAesKey, aesKeyBuf.data(), aesKeyBuf.size()));
-  ckBlock.push_back(makeNonNegativeIntegerBlock(TLV_PlainTextSize, m_plainTextSize));
-  ckBlock.encode();
-  return ckBlock;
+CipherText::makeCKContent() const
+{
+  EncodingEstimator estimator;
+  EncodingBuffer buffer(prependCKContent(estimator), 0);
+  prependCKContent(buffer);
+  return buffer.block();
+}
+
+void
+CipherText::wireDecodeCKContent(const Block& content)
+{
+  if (content.type() != tlv::Content)
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV type when decoding CK content"));
+
+  content.parse();
+  Block::element_const_iterator it = content.elements_begin();
+
+  decodeCipherSuite(it, content.elements_end());
+
+  if (it != content.elements_end() && it->type() == TLV_EncryptedAesKey) {
+    m_cph = makeByteArray(it->value(), it->value_size());
+    it++;
+  }
+  else
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure when decoding encrypted AES key"));
+
+  if (it != content.elements_end() && it->type() == TLV_PlainTextSize) {
+    this->m_plainTextSize = static_cast<uint32_t>(readNonNegativeInteger(*it));
+    it++;
+  }
+
+  if (it != content.elements_end())
+    BOOST_THROW_EXCEPTION(tlv::Error("Unexpected TLV structure after decoding the block"));
 }
 
 
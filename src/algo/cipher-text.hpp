@@ -22,15 +22,74 @@
 #define NDNABAC_ALGO_CIPHER_TEXT_HPP
 
 #include "algo-common.hpp"
+#include "bswabe-ptr.hpp"
 #include "public-params.hpp"
 
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+/**
+ * @brief Symmetric cipher used for the content of a CipherText
+ *
+ * The value is carried in the CipherSuite TLV.  Cipher texts without one use AES_128_CBC.
+ */
+enum class CipherSuite {
+  /**
+   * AES-128-CBC as in libbswabe: zero IV, key from the raw bytes of the GT element,
+   * plain text prefixed with zero padding and its length.
+   */
+  AES_128_CBC = 0,
+  /**
+   * AES-256-GCM: key derived from the GT element with HKDF-SHA256, random 96-bit
+   * nonce, no padding.  The encrypted content is nonce, cipher text, 128-bit tag.
+   */
+  AES_256_GCM = 1,
+  /**
+   * AES-256-GCM over fixed-size chunks, each with its own tag, so that any chunk can be
+   * decrypted on its own.  Key and nonce base are derived from the GT element with
+   * HKDF-SHA256; the nonce of a chunk is the nonce base XOR its index.  The encrypted
+   * content is the cipher text and tag of every chunk in turn; the chunk size is carried
+   * in the ChunkSize TLV.
+   */
+  AES_256_GCM_CHUNKED = 2,
+};
+
+std::ostream&
+operator<<(std::ostream& os, CipherSuite suite);
+
 class CipherText
 {
 public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+public:
+  CipherText() = default;
+
+  /**
+   * @throw Error @p other has a pending plain text (see ABESupport::encryptDeferred),
+   *        which it does not own: such a cipher text can only be moved
+   */
+  CipherText(const CipherText& other);
+
+  /**
+   * @brief Take over the content of @p other, including a pending plain text
+   */
+  CipherText(CipherText&& other);
+
+  /**
+   * @throw Error @p other has a pending plain text
+   */
+  CipherText&
+  operator=(const CipherText& other);
+
+  CipherText&
+  operator=(CipherText&& other);
+
   /**
    * @brief Fast encoding or block size estimation
    */
@@ -51,15 +110,88 @@ public:
   wireDecode(const Block& wire);
 
   Block
-  makeDataContent();
+  makeDataContent() const;
+
+  /**
+   * @brief Encode the content of a Data packet: the cipher suite, the encrypted content,
+   *        then @p ckName
+   *
+   * The block is sized up front, so it is encoded into a single buffer.
+   */
+  Block
+  makeDataContent(const Name& ckName) const;
+
+  /**
+   * @brief Decode the content of a Data packet encoded by makeDataContent(ckName)
+   *
+   * Sets the cipher suite and the encrypted content; the encrypted key is in the CK Data.
+   * @return the CK name
+   */
+  Name
+  wireDecodeDataContent(const Block& content);
 
+  /**
+   * @brief Encode the content of CK Data: the cipher suite, the encrypted key and the
+   *        plain text size
+   */
   Block
-  makeCKContent();
+  makeCKContent() const;
+
+  /**
+   * @brief Decode the content of CK Data encoded by makeCKContent
+   *
+   * Sets everything but the encrypted content, which is in the Data that names the CK.
+   */
+  void
+  wireDecodeCKContent(const Block& content);
+
+  /**
+   * @return the number of chunks in the content of an AES_256_GCM_CHUNKED cipher text
+   */
+  size_t
+  getChunkCount() const;
+
+private:
+  /**
+   * Decode the cipher suite at @p it, and the chunk size after it for chunked content,
+   * moving @p it past them.  Without a CipherSuite TLV the suite is AES_128_CBC.
+   */
+  void
+  decodeCipherSuite(Block::element_const_iterator& it, Block::element_const_iterator end);
+
+  /**
+   * Prepend the EncryptedContent TLV.  A deferred plain text is encrypted right into
+   * the encoder.
+   */
+  size_t
+  prependEncryptedContent(EncodingImpl<encoding::EstimatorTag>& estimator) const;
+
+  size_t
+  prependEncryptedContent(EncodingImpl<encoding::EncoderTag>& encoder) const;
+
+  template<encoding::Tag TAG>
+  size_t
+  prependCipherSuite(EncodingImpl<TAG>& encoder) const;
+
+  template<encoding::Tag TAG>
+  size_t
+  prependDataContent(EncodingImpl<TAG>& encoder, const Name& ckName) const;
+
+  template<encoding::Tag TAG>
+  size_t
+  prependCKContent(EncodingImpl<TAG>& encoder) const;
 
 public:
-  GByteArray* m_cph; // encrypted AES key
+  GByteArrayPtr m_cph; // encrypted AES key
   Buffer m_content; // encrypted content
-  uint32_t m_plainTextSize; // plain text length
+  uint32_t m_plainTextSize = 0; // plain text length
+  CipherSuite m_suite = CipherSuite::AES_128_CBC; // cipher of m_content
+  uint32_t m_chunkSize = 0; // plain text bytes per chunk, AES_256_GCM_CHUNKED only
+
+  // set by ABESupport::encryptDeferred instead of m_content, not owned, so never copied
+  const uint8_t* m_pendingPlainText = nullptr;
+  Buffer m_pendingKey; // m_suite key for m_pendingPlainText
+  Buffer m_pendingAad; // associated data of m_pendingPlainText, AES_256_GCM only
 
   mutable Block m_wire;
 };
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "compiled-policy.hpp"
+
+#include <cstdio>
+#include <sstream>
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+CompiledPolicy::LeafHashes::LeafHashes(shared_ptr<const PreparedPublicParams> pub,
+                                       const std::vector<std::string>& attrs)
+  : m_pub(std::move(pub))
+{
+  auto& cache = AttributeHashCache::getInstance();
+  m_hashes.reserve(attrs.size());
+  for (const auto& attr : attrs) {
+    m_hashes.push_back(cache.get(m_pub, attr));
+  }
+}
+
+CompiledPolicy::CompiledPolicy(const std::string& policy)
+  : m_policy(policy)
+{
+  // same grammar and checks as libbswabe's parse_policy_postfix
+  std::vector<Node> stack;
+  std::istringstream is(policy);
+  std::string token;
+  while (is >> token) {
+    int k = 0, n = 0;
+    if (std::sscanf(token.c_str(), "%dof%d", &k, &n) != 2) {
+      Node leaf;
+      leaf.attr = token;
+      stack.push_back(std::move(leaf));
+      continue;
+    }
+
+    if (k < 1) {
+      BOOST_THROW_EXCEPTION(Error("Trivially satisfied operator " + token));
+    }
+    if (k > n) {
+      BOOST_THROW_EXCEPTION(Error("Unsatisfiable operator " + token));
+    }
+    if (n == 1) {
+      BOOST_THROW_EXCEPTION(Error("Identity operator " + token));
+    }
+    if (static_cast<size_t>(n) > stack.size()) {
+      BOOST_THROW_EXCEPTION(Error("Stack underflow at " + token));
+    }
+
+    Node gate;
+    gate.k = k;
+    gate.children.assign(std::make_move_iterator(stack.end() - n),
+                         std::make_move_iterator(stack.end()));
+    stack.erase(stack.end() - n, stack.end());
+    stack.push_back(std::move(gate));
+  }
+
+  if (stack.size() != 1) {
+    BOOST_THROW_EXCEPTION(Error("Malformed policy \"" + policy + "\""));
+  }
+  m_root = std::move(stack.front());
+
+  // number the leaves in encryption (depth-first) order
+  std::function<void(Node&)> indexLeaves = [&] (Node& node) {
+    if (node.isLeaf()) {
+      node.leafIndex = m_leafAttrs.size();
+      m_leafAttrs.push_back(node.attr);
+    }
+    for (auto& child : node.children) {
+      indexLeaves(child);
+    }
+  };
+  indexLeaves(m_root);
+}
+
+shared_ptr<const CompiledPolicy::LeafHashes>
+CompiledPolicy::getLeafHashes(const shared_ptr<const PreparedPublicParams>& pub) const
+{
+  std::lock_guard<std::mutex> lock(m_hashesMutex);
+  if (m_hashes == nullptr || &m_hashes->getPublicParams() != pub.get()) {
+    m_hashes = make_shared<const LeafHashes>(pub, m_leafAttrs);
+  }
+  return m_hashes;
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_COMPILED_POLICY_HPP
+#define NDNABAC_ALGO_COMPILED_POLICY_HPP
+
+#include "algo-common.hpp"
+#include "attribute-hash-cache.hpp"
+
+#include <mutex>
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief A parsed and validated access policy
+ *
+ * The policy is given as a postfix threshold expression, e.g., "foo bar fim 2of3 baf 1of2".
+ * It is parsed once on construction and immutable afterwards, so one instance can be
+ * shared by any number of encryptions, also across threads.  Leaf attributes are hashed
+ * into the pairing group on first use with a set of public parameters.
+ */
+class CompiledPolicy : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  struct Node
+  {
+    bool
+    isLeaf() const
+    {
+      return children.empty();
+    }
+
+    int k = 1; // 1 for leaves, otherwise the threshold
+    std::string attr; // leaves only
+    size_t leafIndex = 0; // leaves only, position in getLeafAttributes()
+    std::vector<Node> children;
+  };
+
+  /**
+   * @brief Leaf attributes mapped into G2 of one set of public parameters
+   */
+  class LeafHashes : noncopyable
+  {
+  public:
+    LeafHashes(shared_ptr<const PreparedPublicParams> pub,
+               const std::vector<std::string>& attrs);
+
+    const PreparedPublicParams&
+    getPublicParams() const
+    {
+      return *m_pub;
+    }
+
+    element_ptr
+    at(size_t leafIndex) const
+    {
+      return m_hashes.at(leafIndex)->get();
+    }
+
+  private:
+    shared_ptr<const PreparedPublicParams> m_pub;
+    std::vector<shared_ptr<const HashedAttribute>> m_hashes;
+  };
+
+public:
+  /**
+   * @throw Error @p policy is not a valid postfix threshold expression
+   */
+  explicit
+  CompiledPolicy(const std::string& policy);
+
+  const std::string&
+  toString() const
+  {
+    return m_policy;
+  }
+
+  const Node&
+  getRoot() const
+  {
+    return m_root;
+  }
+
+  const std::vector<std::string>&
+  getLeafAttributes() const
+  {
+    return m_leafAttrs;
+  }
+
+  /**
+   * @brief Get the leaf attributes hashed with @p pub, computing them on first use
+   */
+  shared_ptr<const LeafHashes>
+  getLeafHashes(const shared_ptr<const PreparedPublicParams>& pub) const;
+
+private:
+  std::string m_policy;
+  Node m_root;
+  std::vector<std::string> m_leafAttrs;
+
+  mutable std::mutex m_hashesMutex;
+  mutable shared_ptr<const LeafHashes> m_hashes;
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_COMPILED_POLICY_HPP
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "decoded-private-key.hpp"
+#include "bswabe-codec.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+DecodedPrivateKey::DecodedPrivateKey(const PublicParams& pubParams, const PrivateKey& prvKey,
+                                     bool preprocess)
+  : m_pub(pubParams.getPrepared())
+{
+  if (m_pub == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Public parameters are required to decode a private key"));
+  }
+  pairing_ptr pairing = m_pub->pairing.get();
+
+  size_t offset = 0;
+  element_init_G2(d, pairing);
+  try {
+    BswabeCodec::readElement(prvKey.m_prv.get(), offset, d);
+    // nComps comes from the wire: the components are only allocated as they are read
+    uint32_t nComps = BswabeCodec::readUint32(prvKey.m_prv.get(), offset);
+    for (uint32_t i = 0; i < nComps; i++) {
+      m_comps.emplace_back();
+      auto& comp = m_comps.back();
+      element_init_G2(comp.d, pairing);
+      element_init_G1(comp.dp, pairing);
+
+      comp.attr = BswabeCodec::readString(prvKey.m_prv.get(), offset);
+      BswabeCodec::readElement(prvKey.m_prv.get(), offset, comp.d);
+      BswabeCodec::readElement(prvKey.m_prv.get(), offset, comp.dp);
+      m_compIndex.emplace(comp.attr, i);
+    }
+  }
+  catch (...) {
+    // also std::bad_alloc, so that no element leaks
+    element_clear(d);
+    for (auto& comp : m_comps) {
+      element_clear(comp.d);
+      element_clear(comp.dp);
+    }
+    throw;
+  }
+
+  // pairing_pp_t preprocesses the first argument, while the key elements are the
+  // second one in e(C, D); swapping them relies on e(a,b) = e(b,a)
+  m_isPreprocessed = preprocess && m_pub->pairing.isSymmetric();
+  if (m_isPreprocessed) {
+    pairing_pp_init(dPp, d, pairing);
+    for (auto& comp : m_comps) {
+      pairing_pp_init(comp.dPp, comp.d, pairing);
+      pairing_pp_init(comp.dpPp, comp.dp, pairing);
+    }
+  }
+}
+
+DecodedPrivateKey::~DecodedPrivateKey()
+{
+  if (m_isPreprocessed) {
+    pairing_pp_clear(dPp);
+  }
+  element_clear(d);
+  for (auto& comp : m_comps) {
+    if (m_isPreprocessed) {
+      pairing_pp_clear(comp.dPp);
+      pairing_pp_clear(comp.dpPp);
+    }
+    element_clear(comp.d);
+    element_clear(comp.dp);
+  }
+}
+
+const DecodedPrivateKey::Component*
+DecodedPrivateKey::findComponent(const std::string& attr) const
+{
+  auto it = m_compIndex.find(attr);
+  if (it == m_compIndex.end()) {
+    return nullptr;
+  }
+  return &m_comps[it->second];
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
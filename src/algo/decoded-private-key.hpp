@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_DECODED_PRIVATE_KEY_HPP
+#define NDNABAC_ALGO_DECODED_PRIVATE_KEY_HPP
+
+#include "algo-common.hpp"
+#include "public-params.hpp"
+#include "private-key.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief A private key decoded against the public parameters it was issued under
+ *
+ * Decoding happens once, when the key is received, and attributes are indexed for
+ * the decryption planner.  ABESupport::decrypt can then use the key for any number
+ * of cipher texts.
+ *
+ * With a symmetric pairing, as libbswabe uses, every pairing of a decryption has a key
+ * element (D, D_j or D'_j) as one argument, so the key also carries the preprocessed
+ * Miller-loop state (pairing_pp_t) of each of them.
+ */
+class DecodedPrivateKey : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  struct Component
+  {
+    std::string attr;
+    element_t d;  // G2, gp^r * H(attr)^r_j
+    element_t dp; // G1, g^r_j
+    pairing_pp_t dPp;  // if isPreprocessed()
+    pairing_pp_t dpPp; // if isPreprocessed()
+  };
+
+public:
+  /**
+   * @param preprocess whether to build the pairing_pp_t tables; ignored for asymmetric
+   *                   pairings, whose keys are always evaluated as one product of pairings
+   * @throw Error the public parameters are not available yet
+   * @throw BswabeCodec::Error @p prvKey is malformed
+   */
+  DecodedPrivateKey(const PublicParams& pubParams, const PrivateKey& prvKey,
+                    bool preprocess = true);
+
+  ~DecodedPrivateKey();
+
+  const PreparedPublicParams&
+  getPublicParams() const
+  {
+    return *m_pub;
+  }
+
+  /**
+   * @return the component for @p attr, or nullptr if the key has no such attribute
+   */
+  const Component*
+  findComponent(const std::string& attr) const;
+
+  const std::vector<Component>&
+  getComponents() const
+  {
+    return m_comps;
+  }
+
+  bool
+  isPreprocessed() const
+  {
+    return m_isPreprocessed;
+  }
+
+public:
+  element_t d; // G2, (g^alpha * gp^r)^(1/beta)
+  pairing_pp_t dPp; // if isPreprocessed()
+
+private:
+  // the key elements live in this pairing, so keep it alive as long as the key
+  shared_ptr<const PreparedPublicParams> m_pub;
+  std::vector<Component> m_comps;
+  std::map<std::string, size_t> m_compIndex;
+  bool m_isPreprocessed = false;
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_DECODED_PRIVATE_KEY_HPP
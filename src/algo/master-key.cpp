@@ -18,10 +18,58 @@
  * See AUTHORS.md for complete list of ndnabac authors and contributors.
  */
 
+#include "master-key.hpp"
+
+#include <mutex>
+
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+static std::mutex g_preparedMutex;
+
+MasterKey::MasterKey(const MasterKey& other)
+  : m_msk(copyByteArray(other.m_msk.get()))
+{
+}
+
+MasterKey&
+MasterKey::operator=(const MasterKey& other)
+{
+  return *this = MasterKey(other);
+}
+
+Buffer
+MasterKey::toBuffer() const
+{
+  return Buffer(m_msk->data, m_msk->data + m_msk->len);
+}
+
+void
+MasterKey::fromBuffer(const Buffer& buffer)
+{
+  m_msk = makeByteArray(buffer.data(), buffer.size());
+}
+
+shared_ptr<const PreparedMasterKey>
+MasterKey::getPrepared(const PublicParams& pubParams) const
+{
+  auto pub = pubParams.getPrepared();
+  if (m_msk == nullptr || pub == nullptr) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(g_preparedMutex);
+  if (m_prepared != nullptr && hasContents(m_msk.get(), m_preparedSource) &&
+      m_prepared->getPublicParams() == pub) {
+    return m_prepared;
+  }
+
+  m_prepared = make_shared<const PreparedMasterKey>(pub, m_msk.get());
+  m_preparedSource = Buffer(m_msk->data, m_msk->len);
+  return m_prepared;
+}
+
 } // namespace algo
 } // namespace ndnabac
 } // namespace ndn
@@ -22,6 +22,7 @@
 #define NDNABAC_ALGO_MASKER_KEY_HPP
 
 #include "algo-common.hpp"
+#include "public-params.hpp"
 
 namespace ndn {
 namespace ndnabac {
@@ -30,7 +31,39 @@ namespace algo {
 class MasterKey
 {
 public:
-  GByteArray* m_msk;
+  MasterKey() = default;
+
+  MasterKey(const MasterKey& other);
+
+  MasterKey(MasterKey&&) = default;
+
+  MasterKey&
+  operator=(const MasterKey& other);
+
+  MasterKey&
+  operator=(MasterKey&&) = default;
+
+  Buffer
+  toBuffer() const;
+
+  void
+  fromBuffer(const Buffer& buffer);
+
+  /**
+   * @brief Get the master key decoded against @p pubParams
+   *
+   * Decoding happens on first use and is reused until m_msk changes.
+   * @return nullptr if the key or the public parameters are not set
+   */
+  shared_ptr<const PreparedMasterKey>
+  getPrepared(const PublicParams& pubParams) const;
+
+public:
+  GByteArrayPtr m_msk;
+
+private:
+  mutable shared_ptr<const PreparedMasterKey> m_prepared;
+  mutable Buffer m_preparedSource; // contents of m_msk that m_prepared was built from
 };
 
 } // namespace algo
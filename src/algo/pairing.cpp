@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "pairing.hpp"
+#include "bswabe-codec.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+G::G()
+{
+  m_element->field = nullptr;
+}
+
+G::G(const G& other)
+  : G()
+{
+  if (other.m_element->field != nullptr) {
+    element_init_same_as(m_element, other.get());
+    element_set(m_element, other.get());
+  }
+}
+
+G::G(G&& other) noexcept
+{
+  m_element[0] = other.m_element[0];
+  other.m_element->field = nullptr;
+}
+
+G::~G()
+{
+  if (m_element->field != nullptr) {
+    element_clear(m_element);
+  }
+}
+
+G&
+G::operator=(G other) noexcept
+{
+  std::swap(m_element[0], other.m_element[0]);
+  return *this;
+}
+
+bool
+G::operator==(const G& other) const
+{
+  return element_cmp(get(), other.get()) == 0;
+}
+
+Buffer
+G::toBuffer() const
+{
+  Buffer buffer(element_length_in_bytes(get()));
+  element_to_bytes(buffer.data(), get());
+  return buffer;
+}
+
+Pairing::Pairing(const std::string& pairingParams)
+  : m_pairingParams(pairingParams)
+{
+  if (pairing_init_set_buf(m_pairing, m_pairingParams.data(), m_pairingParams.size()) != 0) {
+    BOOST_THROW_EXCEPTION(Error("Cannot parse pairing parameters"));
+  }
+}
+
+Pairing::~Pairing()
+{
+  pairing_clear(m_pairing);
+}
+
+bool
+Pairing::isSymmetric() const
+{
+  return pairing_is_symmetric(get()) != 0;
+}
+
+ZP
+Pairing::initZP() const
+{
+  ZP z;
+  element_init_Zr(z.m_element, get());
+  return z;
+}
+
+G1
+Pairing::initG1() const
+{
+  G1 g;
+  element_init_G1(g.m_element, get());
+  return g;
+}
+
+G2
+Pairing::initG2() const
+{
+  G2 g;
+  element_init_G2(g.m_element, get());
+  return g;
+}
+
+GT
+Pairing::initGT() const
+{
+  GT g;
+  element_init_GT(g.m_element, get());
+  return g;
+}
+
+ZP
+Pairing::randomZP() const
+{
+  ZP z = initZP();
+  element_random(z.get());
+  return z;
+}
+
+G1
+Pairing::randomG1() const
+{
+  G1 g = initG1();
+  element_random(g.get());
+  return g;
+}
+
+G2
+Pairing::randomG2() const
+{
+  G2 g = initG2();
+  element_random(g.get());
+  return g;
+}
+
+G1
+Pairing::hashToG1(const std::string& str) const
+{
+  G1 g = initG1();
+  BswabeCodec::hashToElement(g.get(), str);
+  return g;
+}
+
+GT
+Pairing::pairing(const G1& g1, const G2& g2) const
+{
+  GT gt = initGT();
+  pairing_apply(gt.get(), g1.get(), g2.get(), get());
+  return gt;
+}
+
+void
+Pairing::multi_pairing(GT& gt, const std::vector<G1>& g1, const std::vector<G2>& g2) const
+{
+  if (g1.size() != g2.size()) {
+    BOOST_THROW_EXCEPTION(Error("Pairing arguments differ in size"));
+  }
+  if (g1.empty()) {
+    element_set1(gt.get());
+    return;
+  }
+
+  // pbc wants contiguous arrays; the copies share the elements' data and are never cleared
+  std::vector<element_s> in1, in2;
+  in1.reserve(g1.size());
+  in2.reserve(g2.size());
+  for (size_t i = 0; i < g1.size(); i++) {
+    in1.push_back(*g1[i].get());
+    in2.push_back(*g2[i].get());
+  }
+  element_prod_pairing(gt.get(), reinterpret_cast<element_t*>(in1.data()),
+                       reinterpret_cast<element_t*>(in2.data()), static_cast<int>(in1.size()));
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
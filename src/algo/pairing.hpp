@@ -1,59 +1,197 @@
-
-/// \file   zpairing.h
-///
-/// \brief  Class definition for bilinear maps (or pairings).
-///
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
 
 #ifndef NDNABAC_ALGO_PAIRING_HPP
 #define NDNABAC_ALGO_PAIRING_HPP
 
 #include "algo-common.hpp"
-#include "public-params.hpp"
-#include "master-key.hpp"
-#include "private-key.hpp"
-#include "signed-message.hpp"
-
-#include <openssl/aes.h>
-#include <openssl/sha.h>
-#include <openssl/rand.h>
-#include <mutex>
 
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
-class Pairing {
+class Pairing;
+
+/**
+ * @brief A pbc element that is cleared when it goes out of scope
+ *
+ * Elements are created by a Pairing, which must outlive them.  A moved-from
+ * element holds nothing and may only be destroyed or assigned to.
+ */
+class G
+{
 public:
-  Pairing(const std::string &pairingParams);
-  Pairing(const Pairing &copyFrom);
-  ~Pairing();
-  void     initZP(ZP& z, uint32_t v);
-  ZP       initZP();
-  G1       initG1();
-  G2       initG2();
-  GT       initGT();
+  G(const G& other);
+
+  G(G&& other) noexcept;
+
+  ~G();
 
-  ZP       randomZP(RNG *rng);
-  G1       randomG1(RNG *rng);
-  G2       randomG2(RNG *rng);
+  G&
+  operator=(G other) noexcept;
 
-  GByteArray* hashToBytes(uint8_t*, uint32_t);
-  GByteArray* hashFromBytes(GByteArray &buf, uint32_t target_len, uint8_t hash_prefix);
+  element_ptr
+  get() const
+  {
+    return const_cast<element_ptr>(m_element);
+  }
 
-  G1       hashToG1(GByteArray*, std::string);
-  GT       pairing(G1& g1, G2& g2);
-  void     multi_pairing(GT& gt, std::vector<G1>& g1, std::vector<G2>& g2);
+  bool
+  operator==(const G& other) const;
 
-  std::string  getPairingParams() const;
-  std::string  getCurveID() const;
+  bool
+  operator!=(const G& other) const
+  {
+    return !(*this == other);
+  }
+
+  Buffer
+  toBuffer() const;
 
 protected:
-  bool         isSymmetric;
-  std::string  curveID;
-  std::string  pairingParams;
+  G();
+
+private:
+  element_t m_element;
+
+  friend class Pairing;
+};
+
+class ZP : public G
+{
+private:
+  ZP() = default;
+
+  friend class Pairing;
+};
+
+class G1 : public G
+{
+private:
+  G1() = default;
+
+  friend class Pairing;
 };
-}
-}
-}
 
-#endif	// __PAIRING_H__
\ No newline at end of file
+class G2 : public G
+{
+private:
+  G2() = default;
+
+  friend class Pairing;
+};
+
+class GT : public G
+{
+private:
+  GT() = default;
+
+  friend class Pairing;
+};
+
+/**
+ * @brief A bilinear map e: G1 x G2 -> GT, backed by a pbc pairing
+ *
+ * All const member functions only read the pairing and may be called concurrently.
+ */
+class Pairing : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+public:
+  /**
+   * @param pairingParams pbc pairing parameters, e.g., the pairing_desc of bswabe public params
+   * @throw Error @p pairingParams cannot be parsed
+   */
+  explicit
+  Pairing(const std::string& pairingParams);
+
+  ~Pairing();
+
+  pairing_ptr
+  get() const
+  {
+    return const_cast<pairing_ptr>(m_pairing);
+  }
+
+  const std::string&
+  getPairingParams() const
+  {
+    return m_pairingParams;
+  }
+
+  bool
+  isSymmetric() const;
+
+  ZP
+  initZP() const;
+
+  G1
+  initG1() const;
+
+  G2
+  initG2() const;
+
+  GT
+  initGT() const;
+
+  ZP
+  randomZP() const;
+
+  G1
+  randomG1() const;
+
+  G2
+  randomG2() const;
+
+  /**
+   * @brief Hash @p str into G1 the way libbswabe hashes attributes, SHA-1 then element_from_hash
+   */
+  G1
+  hashToG1(const std::string& str) const;
+
+  GT
+  pairing(const G1& g1, const G2& g2) const;
+
+  /**
+   * @brief Set @p gt to the product of e(@p g1[i], @p g2[i])
+   *
+   * The Miller loops of all pairs share their squarings and the product gets a single
+   * final exponentiation, so this is much cheaper than computing the pairings one by one.
+   * @throw Error @p g1 and @p g2 differ in size
+   */
+  void
+  multi_pairing(GT& gt, const std::vector<G1>& g1, const std::vector<G2>& g2) const;
+
+private:
+  std::string m_pairingParams;
+  pairing_t m_pairing;
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_PAIRING_HPP
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "prepared-params.hpp"
+#include "bswabe-codec.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+static std::string
+readPairingDesc(const GByteArray* pub)
+{
+  size_t offset = 0;
+  return BswabeCodec::readString(pub, offset);
+}
+
+PreparedPublicParams::PreparedPublicParams(const GByteArray* pub)
+  : pairing(readPairingDesc(pub))
+{
+  // the elements follow the NUL-terminated pairing description
+  size_t offset = pairing.getPairingParams().size() + 1;
+
+  element_init_G1(g, pairing.get());
+  element_init_G1(h, pairing.get());
+  element_init_G2(gp, pairing.get());
+  element_init_GT(gHatAlpha, pairing.get());
+
+  try {
+    BswabeCodec::readElement(pub, offset, g);
+    BswabeCodec::readElement(pub, offset, h);
+    BswabeCodec::readElement(pub, offset, gp);
+    BswabeCodec::readElement(pub, offset, gHatAlpha);
+  }
+  catch (const BswabeCodec::Error&) {
+    element_clear(g);
+    element_clear(h);
+    element_clear(gp);
+    element_clear(gHatAlpha);
+    throw;
+  }
+
+  element_pp_init(gTable, g);
+  element_pp_init(hTable, h);
+  element_pp_init(gpTable, gp);
+  element_pp_init(gHatAlphaTable, gHatAlpha);
+}
+
+PreparedPublicParams::~PreparedPublicParams()
+{
+  element_pp_clear(gTable);
+  element_pp_clear(hTable);
+  element_pp_clear(gpTable);
+  element_pp_clear(gHatAlphaTable);
+
+  element_clear(g);
+  element_clear(h);
+  element_clear(gp);
+  element_clear(gHatAlpha);
+}
+
+PreparedMasterKey::PreparedMasterKey(shared_ptr<const PreparedPublicParams> pub,
+                                     const GByteArray* msk)
+  : m_pub(std::move(pub))
+{
+  pairing_ptr pairing = m_pub->pairing.get();
+  element_init_Zr(beta, pairing);
+  element_init_Zr(betaInv, pairing);
+  element_init_G2(gAlpha, pairing);
+  element_init_G2(gAlphaBetaInv, pairing);
+
+  try {
+    size_t offset = 0;
+    BswabeCodec::readElement(msk, offset, beta);
+    BswabeCodec::readElement(msk, offset, gAlpha);
+  }
+  catch (const BswabeCodec::Error&) {
+    element_clear(beta);
+    element_clear(betaInv);
+    element_clear(gAlpha);
+    element_clear(gAlphaBetaInv);
+    throw;
+  }
+
+  element_invert(betaInv, beta);
+  element_pow_zn(gAlphaBetaInv, gAlpha, betaInv);
+}
+
+PreparedMasterKey::~PreparedMasterKey()
+{
+  element_clear(beta);
+  element_clear(betaInv);
+  element_clear(gAlpha);
+  element_clear(gAlphaBetaInv);
+}
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
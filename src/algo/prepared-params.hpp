@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_ALGO_PREPARED_PARAMS_HPP
+#define NDNABAC_ALGO_PREPARED_PARAMS_HPP
+
+#include "algo-common.hpp"
+#include "pairing.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace algo {
+
+/**
+ * @brief Public parameters decoded into pbc elements, with fixed-base tables
+ *
+ * Encryption and key generation exponentiate the same bases over and over: g and h
+ * (G1), gp (G2) and e(g,g)^alpha (GT).  Each of them gets an element_pp_t table,
+ * built once when the parameters are decoded and read-only afterwards.
+ */
+class PreparedPublicParams : noncopyable
+{
+public:
+  /**
+   * @param pub public parameters serialized by bswabe_pub_serialize
+   * @throw BswabeCodec::Error @p pub is malformed
+   * @throw Pairing::Error the pairing description in @p pub is invalid
+   */
+  explicit
+  PreparedPublicParams(const GByteArray* pub);
+
+  ~PreparedPublicParams();
+
+public:
+  Pairing pairing;
+  element_t g;         // G1
+  element_t h;         // G1, g^beta
+  element_t gp;        // G2
+  element_t gHatAlpha; // GT, e(g,gp)^alpha
+
+  element_pp_t gTable;
+  element_pp_t hTable;
+  element_pp_t gpTable;
+  element_pp_t gHatAlphaTable;
+};
+
+/**
+ * @brief Master key decoded into pbc elements
+ *
+ * Besides beta and g^alpha this keeps (g^alpha)^(1/beta), the part of the key
+ * component D that does not depend on the per-key randomness, so key generation
+ * only needs fixed-base exponentiations.
+ */
+class PreparedMasterKey : noncopyable
+{
+public:
+  /**
+   * @param msk master key serialized by bswabe_msk_serialize
+   * @throw BswabeCodec::Error @p msk is malformed
+   */
+  PreparedMasterKey(shared_ptr<const PreparedPublicParams> pub, const GByteArray* msk);
+
+  ~PreparedMasterKey();
+
+  const shared_ptr<const PreparedPublicParams>&
+  getPublicParams() const
+  {
+    return m_pub;
+  }
+
+public:
+  element_t beta;          // Zr
+  element_t betaInv;       // Zr
+  element_t gAlpha;        // G2
+  element_t gAlphaBetaInv; // G2, gAlpha^(1/beta)
+
+private:
+  // the elements live in this pairing
+  shared_ptr<const PreparedPublicParams> m_pub;
+};
+
+} // namespace algo
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_ALGO_PREPARED_PARAMS_HPP
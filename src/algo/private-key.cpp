@@ -24,6 +24,17 @@ namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+PrivateKey::PrivateKey(const PrivateKey& other)
+  : m_prv(copyByteArray(other.m_prv.get()))
+{
+}
+
+PrivateKey&
+PrivateKey::operator=(const PrivateKey& other)
+{
+  return *this = PrivateKey(other);
+}
+
 Buffer
 PrivateKey::toBuffer()
 {
@@ -38,9 +49,7 @@ PrivateKey::toBuffer()
 void
 PrivateKey::fromBuffer(const Buffer& buffer)
 {
-  Buffer tempBuf(buffer.data(), buffer.size());
-  m_prv = g_byte_array_new();
-  g_byte_array_append(m_prv, tempBuf.data(), static_cast<guint>(tempBuf.size()));
+  m_prv = makeByteArray(buffer.data(), buffer.size());
 }
 
 } // namespace algo
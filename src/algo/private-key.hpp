@@ -22,6 +22,7 @@
 #define NDNABAC_ALGO_PRIVATE_KEY_HPP
 
 #include "algo-common.hpp"
+#include "bswabe-ptr.hpp"
 
 namespace ndn {
 namespace ndnabac {
@@ -30,6 +31,18 @@ namespace algo {
 class PrivateKey
 {
 public:
+  PrivateKey() = default;
+
+  PrivateKey(const PrivateKey& other);
+
+  PrivateKey(PrivateKey&&) = default;
+
+  PrivateKey&
+  operator=(const PrivateKey& other);
+
+  PrivateKey&
+  operator=(PrivateKey&&) = default;
+
   Buffer
   toBuffer();
 
@@ -37,7 +50,7 @@ public:
   fromBuffer(const Buffer& block);
 
 public:
-  GByteArray* m_prv;
+  GByteArrayPtr m_prv;
 };
 
 } // namespace algo
@@ -20,12 +20,67 @@
 
 #include "public-params.hpp"
 
+#include <mutex>
+
 namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+namespace {
+
+std::mutex g_preparedMutex;
+std::map<std::string/* SHA-256 of serialized params */, weak_ptr<const PreparedPublicParams>> g_prepared;
+
+std::string
+digestOf(const GByteArray* pub)
+{
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(pub->data, pub->len, reinterpret_cast<unsigned char*>(&digest[0]));
+  return digest;
+}
+
+/**
+ * Look up @p digest in @p cache, creating the object with @p make if nobody holds it.
+ * Must be called with g_preparedMutex held.
+ */
+template<typename T, typename Factory>
+shared_ptr<T>
+findOrCreate(std::map<std::string, weak_ptr<T>>& cache, const std::string& digest,
+             const Factory& make)
+{
+  auto object = cache[digest].lock();
+  if (object != nullptr) {
+    return object;
+  }
+
+  object = make();
+  cache[digest] = object;
+
+  // drop entries whose parameters are no longer used by anyone
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (it->second.expired())
+      it = cache.erase(it);
+    else
+      ++it;
+  }
+  return object;
+}
+
+} // namespace
+
+PublicParams::PublicParams(const PublicParams& other)
+  : m_pub(copyByteArray(other.m_pub.get()))
+{
+}
+
+PublicParams&
+PublicParams::operator=(const PublicParams& other)
+{
+  return *this = PublicParams(other);
+}
+
 Buffer
-PublicParams::toBuffer()
+PublicParams::toBuffer() const
 {
   // struct GByteArray {
   //   guint8 *data;
@@ -37,9 +92,27 @@ PublicParams::toBuffer()
 void
 PublicParams::fromBuffer(const Buffer& buffer)
 {
-  Buffer tempBuf(buffer.data(), buffer.size());
-  m_pub = g_byte_array_new();
-  g_byte_array_append(m_pub, tempBuf.data(), static_cast<guint>(tempBuf.size()));
+  m_pub = makeByteArray(buffer.data(), buffer.size());
+}
+
+shared_ptr<const PreparedPublicParams>
+PublicParams::getPrepared() const
+{
+  if (m_pub == nullptr) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(g_preparedMutex);
+  if (m_prepared != nullptr && hasContents(m_pub.get(), m_preparedSource)) {
+    return m_prepared;
+  }
+
+  auto digest = digestOf(m_pub.get());
+  m_prepared = findOrCreate(g_prepared, digest, [this] {
+      return make_shared<const PreparedPublicParams>(m_pub.get());
+    });
+  m_preparedSource = Buffer(m_pub->data, m_pub->len);
+  return m_prepared;
 }
 
 } // namespace algo
@@ -22,6 +22,8 @@
 #define NDNABAC_ALGO_PUBLIC_PARAMS_HPP
 
 #include "algo-common.hpp"
+#include "prepared-params.hpp"
+#include "bswabe-ptr.hpp"
 
 namespace ndn {
 namespace ndnabac {
@@ -30,14 +32,45 @@ namespace algo {
 class PublicParams
 {
 public:
+  PublicParams() = default;
+
+  /**
+   * @brief Copy the serialized parameters; the decoded copy is looked up again on use
+   */
+  PublicParams(const PublicParams& other);
+
+  PublicParams(PublicParams&&) = default;
+
+  PublicParams&
+  operator=(const PublicParams& other);
+
+  PublicParams&
+  operator=(PublicParams&&) = default;
+
   Buffer
-  toBuffer();
+  toBuffer() const;
 
   void
   fromBuffer(const Buffer& buffer);
 
+  /**
+   * @brief Get the public parameters decoded into pbc elements, with fixed-base tables
+   *
+   * The parameters are decoded on first use and then reused.  Instances holding the
+   * same serialized parameters (e.g., fetched from the same attribute authority) share
+   * one decoded copy per process, looked up by the SHA-256 digest of m_pub.
+   * @throw BswabeCodec::Error m_pub is malformed
+   */
+  shared_ptr<const PreparedPublicParams>
+  getPrepared() const;
+
 public:
-  GByteArray* m_pub;
+  GByteArrayPtr m_pub;
+
+private:
+  // the contents of m_pub m_prepared was decoded from; m_pub may be replaced at any time
+  mutable shared_ptr<const PreparedPublicParams> m_prepared;
+  mutable Buffer m_preparedSource;
 };
 
 } // namespace algo
@@ -25,6 +25,20 @@ namespace ndn {
 namespace ndnabac {
 namespace algo {
 
+SignedMessage::SignedMessage(const SignedMessage& other)
+  : m_sgn(copyByteArray(other.m_sgn.get()))
+  , m_signedmsg(other.m_signedmsg)
+  , m_plainTextSize(other.m_plainTextSize)
+  , m_wire(other.m_wire)
+{
+}
+
+SignedMessage&
+SignedMessage::operator=(const SignedMessage& other)
+{
+  return *this = SignedMessage(other);
+}
+
 template<encoding::Tag TAG>
 size_t
 SignedMessage::wireEncode(EncodingImpl<TAG>& encoder) const
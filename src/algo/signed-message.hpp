@@ -22,6 +22,7 @@
 #define NDNABAC_ALGO_SIGNED_MESSAGE_HPP
 
 #include "algo-common.hpp"
+#include "bswabe-ptr.hpp"
 #include "public-params.hpp"
 
 namespace ndn {
@@ -31,6 +32,18 @@ namespace algo {
 class SignedMessage
 {
 public:
+  SignedMessage() = default;
+
+  SignedMessage(const SignedMessage& other);
+
+  SignedMessage(SignedMessage&&) = default;
+
+  SignedMessage&
+  operator=(const SignedMessage& other);
+
+  SignedMessage&
+  operator=(SignedMessage&&) = default;
+
   /**
    * @brief Fast encoding or block size estimation
    */
@@ -57,9 +70,9 @@ public:
   makeCKContent();
 
 public:
-  GByteArray* m_sgn; // encrypted AES key
+  GByteArrayPtr m_sgn; // encrypted AES key
   Buffer m_signedmsg; // encrypted content
-  uint32_t m_plainTextSize; // plain text length
+  uint32_t m_plainTextSize = 0; // plain text length
 
   mutable Block m_wire;
 };
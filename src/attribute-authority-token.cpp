@@ -19,6 +19,7 @@
  */
 
 #include "attribute-authority-token.hpp"
+#include "abe-key-file.hpp"
 #include "json-helper.hpp"
 #include "token-issuer.hpp"
 #include "ndn-crypto/data-enc-dec.hpp"
@@ -26,6 +27,7 @@
 #include <ndn-cxx/security/transform/public-key.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/security/verification-helpers.hpp>
+#include <ndn-cxx/util/sha256.hpp>
 
 namespace ndn {
 namespace ndnabac {
@@ -36,16 +38,30 @@ NDN_LOG_INIT(ndnabac.attribute-authority);
 const Name AttributeAuthorityToken::PUBLIC_PARAMS = "/PUBPARAMS";
 const Name AttributeAuthorityToken::DECRYPT_KEY = "/DKEY-TOKEN";
 
+// the public parameters never change, so caches may keep them for long
+static const time::milliseconds PUBLIC_PARAMS_FRESHNESS_PERIOD = time::hours(24);
+
 //public
 AttributeAuthorityToken::AttributeAuthorityToken(const security::v2::Certificate& identityCert, Face& face,
-                                                 security::v2::KeyChain& keyChain)
+                                                 security::v2::KeyChain& keyChain,
+                                                 const std::string& keyFile)
   : m_cert(identityCert)
   , m_face(face)
   , m_keyChain(keyChain)
 {
-  // ABE setup
-  NDN_LOG_INFO("Set up public parameters and master key.");
-  algo::ABESupport::setup(m_pubParams, m_masterKey);
+  // ABE setup, unless the keys of an earlier run (or of a replica) are on disk
+  if (!keyFile.empty() &&
+      AbeKeyFile::load(keyFile, m_keyChain.getTpm(), m_cert.getName(), m_pubParams, m_masterKey)) {
+    NDN_LOG_INFO("Reuse public parameters and master key from " << keyFile);
+  }
+  else {
+    NDN_LOG_INFO("Set up public parameters and master key.");
+    algo::ABESupport::setup(m_pubParams, m_masterKey);
+    if (!keyFile.empty()) {
+      AbeKeyFile::save(keyFile, m_pubParams, m_masterKey, m_cert);
+    }
+  }
+  makePublicParamsData();
 
   // prefix registration
   auto prefixId = m_face.registerPrefix(m_cert.getIdentity(),
@@ -95,14 +111,10 @@ AttributeAuthorityToken::onDecryptionKeyRequest(const Interest& interest)
 
   // verify token
   Name tokenIssuerKey = token.getSignature().getKeyLocator().getName();
-  for (auto anchor : m_trustConfig.m_trustAnchors) {
-    if (anchor.getKeyName() == tokenIssuerKey) {
-      if (!security::verifySignature(token, anchor)) {
-        NDN_LOG_TRACE("Invalid token");
-        return;
-      }
-      break;
-    }
+  auto anchor = m_trustConfig.findByKeyName(tokenIssuerKey);
+  if (anchor != nullptr && !security::verifySignature(token, *anchor)) {
+    NDN_LOG_TRACE("Invalid token");
+    return;
   }
 
   // parse token
@@ -133,22 +145,25 @@ AttributeAuthorityToken::onDecryptionKeyRequest(const Interest& interest)
 void
 AttributeAuthorityToken::onPublicParamsRequest(const Interest& interest)
 {
-  // naming: /AA-prefix/PUBLICPARAMS
+  // naming: /AA-prefix/PUBPARAMS[/<digest>]
   NDN_LOG_INFO("on public Params request:"<<interest.getName());
-  Data result;
-  Name dataName = interest.getName();
-  dataName.appendTimestamp();
-  result.setName(dataName);
-  const auto& contentBuf = m_pubParams.toBuffer();
-  result.setContent(makeBinaryBlock(ndn::tlv::Content,
-                                    contentBuf.data(), contentBuf.size()));
-  NDN_LOG_DEBUG("before sign");
-  m_keyChain.sign(result, signingByCertificate(m_cert));
-
-  NDN_LOG_TRACE("Reply public params request.");
-  NDN_LOG_TRACE("Pub params size: " << contentBuf.size());
+  m_face.put(m_pubParamsData);
+}
 
-  m_face.put(result);
+void
+AttributeAuthorityToken::makePublicParamsData()
+{
+  const auto& contentBuf = m_pubParams.toBuffer();
+  auto digest = util::Sha256::computeDigest(contentBuf.data(), contentBuf.size());
+
+  Name dataName = m_cert.getIdentity();
+  dataName.append(PUBLIC_PARAMS).append(name::Component(digest));
+  m_pubParamsData.setName(dataName);
+  m_pubParamsData.setFreshnessPeriod(PUBLIC_PARAMS_FRESHNESS_PERIOD);
+  m_pubParamsData.setContent(makeBinaryBlock(ndn::tlv::Content,
+                                             contentBuf.data(), contentBuf.size()));
+  m_keyChain.sign(m_pubParamsData, signingByCertificate(m_cert));
+  NDN_LOG_TRACE("Pub params " << dataName << ", size: " << contentBuf.size());
 }
 
 void
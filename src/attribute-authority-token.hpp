@@ -31,8 +31,18 @@ namespace ndnabac {
 class AttributeAuthorityToken
 {
 public:
+  /**
+   * @brief Constructor
+   *
+   * @param keyFile where the public parameters and master key are kept across restarts,
+   *        sealed with the key of @p identityCert (an RSA key), see AbeKeyFile.  The keys
+   *        are generated and saved there if the file does not exist yet; if empty, they
+   *        are generated on every start.
+   * @throw AbeKeyFile::Error @p keyFile exists but cannot be loaded
+   */
   AttributeAuthorityToken(const security::v2::Certificate& identityCert, Face& m_face,
-                          security::v2::KeyChain& keyChain);
+                          security::v2::KeyChain& keyChain,
+                          const std::string& keyFile = "");
 
   ~AttributeAuthorityToken();
 
@@ -43,6 +53,12 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   void
   onPublicParamsRequest(const Interest& interest);
 
+  /**
+   * @brief Sign the public parameters once, as /<AA>/PUBPARAMS/<digest of the parameters>
+   */
+  void
+  makePublicParamsData();
+
   void
   onRegisterFailed(const std::string& reason);
 
@@ -59,6 +75,7 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   security::v2::KeyChain& m_keyChain;
 
   algo::PublicParams m_pubParams;
+  Data m_pubParamsData;
   algo::MasterKey m_masterKey;
 
   TrustConfig m_trustConfig;
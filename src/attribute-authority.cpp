@@ -19,6 +19,7 @@
  */
 
 #include "attribute-authority.hpp"
+#include "abe-key-file.hpp"
 #include "json-helper.hpp"
 #include "token-issuer.hpp"
 #include "ndn-crypto/data-enc-dec.hpp"
@@ -26,6 +27,7 @@
 #include <ndn-cxx/security/transform/public-key.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/security/verification-helpers.hpp>
+#include <ndn-cxx/util/sha256.hpp>
 
 namespace ndn {
 namespace ndnabac {
@@ -34,17 +36,39 @@ NDN_LOG_INIT(ndnabac.attribute-authority);
 
 const Name AttributeAuthority::PUBLIC_PARAMS = "/PUBPARAMS";
 const Name AttributeAuthority::DECRYPT_KEY = "/DKEY";
+const size_t AttributeAuthority::DEFAULT_MAX_QUEUED_KEY_REQUESTS = 1024;
+
+static const size_t ISSUED_KEY_CACHE_SIZE = 4096;
+
+// the public parameters never change, so caches may keep them for long
+static const time::milliseconds PUBLIC_PARAMS_FRESHNESS_PERIOD = time::hours(24);
 
 //public
 AttributeAuthority::AttributeAuthority(const security::v2::Certificate& identityCert, Face& face,
-                                       security::v2::KeyChain& keyChain)
+                                       security::v2::KeyChain& keyChain,
+                                       const std::string& keyFile,
+                                       size_t nKeyGenWorkers,
+                                       size_t maxQueuedKeyRequests)
   : m_cert(identityCert)
   , m_face(face)
   , m_keyChain(keyChain)
+  , m_keyGenPool(make_shared<ThreadPool>(nKeyGenWorkers))
+  , m_maxQueuedKeyRequests(maxQueuedKeyRequests)
+  , m_issuedKeys(ISSUED_KEY_CACHE_SIZE)
 {
-  // ABE setup
-  NDN_LOG_INFO("Set up public parameters and master key.");
-  algo::ABESupport::setup(m_pubParams, m_masterKey);
+  // ABE setup, unless the keys of an earlier run (or of a replica) are on disk
+  if (!keyFile.empty() &&
+      AbeKeyFile::load(keyFile, m_keyChain.getTpm(), m_cert.getName(), m_pubParams, m_masterKey)) {
+    NDN_LOG_INFO("Reuse public parameters and master key from " << keyFile);
+  }
+  else {
+    NDN_LOG_INFO("Set up public parameters and master key.");
+    algo::ABESupport::setup(m_pubParams, m_masterKey);
+    if (!keyFile.empty()) {
+      AbeKeyFile::save(keyFile, m_pubParams, m_masterKey, m_cert);
+    }
+  }
+  makePublicParamsData();
 
   // prefix registration
   auto prefixId = m_face.registerPrefix(m_cert.getIdentity(),
@@ -69,6 +93,7 @@ AttributeAuthority::AttributeAuthority(const security::v2::Certificate& identity
 
 AttributeAuthority::~AttributeAuthority()
 {
+  *m_isAlive = false;
   for (auto prefixId : m_interestFilterIds) {
     prefixId.cancel();
   }
@@ -85,57 +110,160 @@ AttributeAuthority::onDecryptionKeyRequest(const Interest& request)
   NDN_LOG_INFO("get DKEY request:"<<request.getName());
   Name identityName(request.getName().at(m_cert.getIdentity().size() + 1).blockFromValue());
 
-  // verify request and generate token
-  JsonSection root;
-  security::v2::Certificate consumerCert;
-  for (auto anchor : m_trustConfig.m_trustAnchors) {
-    if (anchor.getIdentity() == identityName) {
-      if (!security::verifySignature(request, anchor)) {
-        NDN_LOG_TRACE("Interest is with bad signature");
-        return;
-      }
-      consumerCert = anchor;
-      break;
+  // the identity may have several anchors; the signer picks which one the key is for
+  auto consumerCert = m_trustConfig.findBySigner(request);
+  if (consumerCert == nullptr) {
+    NDN_LOG_TRACE("Unknown consumer " << identityName);
+    return;
+  }
+  if (consumerCert->getIdentity() != identityName) {
+    NDN_LOG_TRACE("DKEY request for " << identityName << " signed by " << consumerCert->getKeyName());
+    return;
+  }
+  KeyRequest keyRequest{request, *consumerCert, {}};
+  for (const auto& attrName : m_tokens[identityName]) {
+    keyRequest.attrs.push_back(attrName);
+  }
+
+  // a retry, or a consumer asking again after a restart
+  auto issued = m_issuedKeys.find(getIssuedKeyId(keyRequest));
+  if (issued != nullptr) {
+    if (!security::verifySignature(request, keyRequest.consumerCert)) {
+      NDN_LOG_TRACE("Interest is with bad signature");
+      return;
     }
+    NDN_LOG_DEBUG("reuse the DKEY issued to " << keyRequest.consumerCert.getKeyName());
+    sendKey(request, *issued);
+    return;
   }
-  std::vector<std::string> attrs;
-  for (auto attrName : m_tokens[identityName]) {
-    attrs.push_back(attrName);
+
+  if (m_nQueuedKeyRequests >= m_maxQueuedKeyRequests) {
+    NDN_LOG_INFO("DKEY queue is full, Nack " << request.getName());
+    sendNack(request);
+    return;
   }
 
-  // generate ABE private key and do encryption
-  algo::PrivateKey ABEPrvKey = algo::ABESupport::prvKeyGen(m_pubParams, m_masterKey, attrs);
-  auto prvBuffer = ABEPrvKey.toBuffer();
+  auto& queue = m_keyRequests[identityName];
+  if (queue.empty()) {
+    m_keyRequestRound.push_back(identityName);
+  }
+  queue.push_back(std::move(keyRequest));
+  m_nQueuedKeyRequests++;
+  dispatchKeyRequests();
+}
+
+void
+AttributeAuthority::dispatchKeyRequests()
+{
+  while (m_nRunningKeyRequests < m_keyGenPool->size() && !m_keyRequestRound.empty()) {
+    Name identityName = m_keyRequestRound.front();
+    m_keyRequestRound.pop_front();
+    auto queue = m_keyRequests.find(identityName);
+    auto keyRequest = make_shared<KeyRequest>(std::move(queue->second.front()));
+    queue->second.pop_front();
+    if (queue->second.empty()) {
+      m_keyRequests.erase(queue);
+    }
+    else {
+      m_keyRequestRound.push_back(identityName);
+    }
+    m_nQueuedKeyRequests--;
+    m_nRunningKeyRequests++;
+
+    auto& io = m_face.getIoService();
+    std::weak_ptr<bool> isAlive = m_isAlive;
+    m_keyGenPool->submit([this, keyRequest, &io, isAlive] {
+        Block content;
+        try {
+          if (security::verifySignature(keyRequest->interest, keyRequest->consumerCert)) {
+            // generate ABE private key and do encryption
+            auto prvKey = algo::ABESupport::prvKeyGen(m_pubParams, m_masterKey, keyRequest->attrs);
+            auto prvBuffer = prvKey.toBuffer();
+            const auto& consumerKey = keyRequest->consumerCert.getPublicKey();
+            content = encryptDataContentWithCK(prvBuffer.data(), prvBuffer.size(),
+                                               consumerKey.data(), consumerKey.size());
+          }
+          else {
+            NDN_LOG_TRACE("Interest is with bad signature");
+          }
+        }
+        catch (const std::exception& e) {
+          NDN_LOG_ERROR("Cannot generate DKEY for " << keyRequest->interest.getName()
+                        << ": " << e.what());
+        }
+        io.post([this, keyRequest, content, isAlive] {
+            if (!isAlive.expired() && *isAlive.lock()) {
+              onKeyGenerated(*keyRequest, content);
+            }
+          });
+      });
+  }
+}
+
+void
+AttributeAuthority::onKeyGenerated(const KeyRequest& keyRequest, const Block& content)
+{
+  m_nRunningKeyRequests--;
+  if (!content.empty()) {
+    m_issuedKeys.insert(getIssuedKeyId(keyRequest), content);
+    sendKey(keyRequest.interest, content);
+  }
+  dispatchKeyRequests();
+}
 
-  // reply interest with encrypted private key
+void
+AttributeAuthority::sendKey(const Interest& interest, const Block& content)
+{
+  // reply interest with encrypted private key; signed for every request, as each
+  // signed Interest has its own name
   Data result;
-  result.setName(request.getName());
-  result.setContent(encryptDataContentWithCK(prvBuffer.data(), prvBuffer.size(),
-                                             consumerCert.getPublicKey().data(),
-                                             consumerCert.getPublicKey().size()));
+  result.setName(interest.getName());
+  result.setContent(content);
   m_keyChain.sign(result, signingByCertificate(m_cert));
   m_face.put(result);
 }
 
+AttributeAuthority::IssuedKeyId
+AttributeAuthority::getIssuedKeyId(const KeyRequest& keyRequest)
+{
+  return std::make_tuple(keyRequest.consumerCert.getIdentity(), keyRequest.attrs,
+                         keyRequest.consumerCert.getKeyName());
+}
+
+void
+AttributeAuthority::sendNack(const Interest& interest)
+{
+  // tells the consumer to come back later, rather than letting its Interest time out
+  Data nack;
+  nack.setName(interest.getName());
+  nack.setContentType(tlv::ContentType_Nack);
+  nack.setFreshnessPeriod(time::milliseconds(0));
+  m_keyChain.sign(nack, signingByCertificate(m_cert));
+  m_face.put(nack);
+}
+
 void
 AttributeAuthority::onPublicParamsRequest(const Interest& interest)
 {
-  // naming: /AA-prefix/PUBLICPARAMS
+  // naming: /AA-prefix/PUBPARAMS[/<digest>]
   NDN_LOG_INFO("on public Params request:"<<interest.getName());
-  Data result;
-  Name dataName = interest.getName();
-  dataName.appendTimestamp();
-  result.setName(dataName);
-  const auto& contentBuf = m_pubParams.toBuffer();
-  result.setContent(makeBinaryBlock(ndn::tlv::Content,
-                                    contentBuf.data(), contentBuf.size()));
-  NDN_LOG_DEBUG("before sign");
-  m_keyChain.sign(result, signingByCertificate(m_cert));
+  m_face.put(m_pubParamsData);
+}
 
-  NDN_LOG_TRACE("Reply public params request.");
-  NDN_LOG_TRACE("Pub params size: " << contentBuf.size());
+void
+AttributeAuthority::makePublicParamsData()
+{
+  const auto& contentBuf = m_pubParams.toBuffer();
+  auto digest = util::Sha256::computeDigest(contentBuf.data(), contentBuf.size());
 
-  m_face.put(result);
+  Name dataName = m_cert.getIdentity();
+  dataName.append(PUBLIC_PARAMS).append(name::Component(digest));
+  m_pubParamsData.setName(dataName);
+  m_pubParamsData.setFreshnessPeriod(PUBLIC_PARAMS_FRESHNESS_PERIOD);
+  m_pubParamsData.setContent(makeBinaryBlock(ndn::tlv::Content,
+                                             contentBuf.data(), contentBuf.size()));
+  m_keyChain.sign(m_pubParamsData, signingByCertificate(m_cert));
+  NDN_LOG_TRACE("Pub params " << dataName << ", size: " << contentBuf.size());
 }
 
 void
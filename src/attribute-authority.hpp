@@ -24,6 +24,11 @@
 #include "common.hpp"
 #include "trust-config.hpp"
 #include "algo/abe-support.hpp"
+#include "thread-pool.hpp"
+#include "lru-cache.hpp"
+
+#include <deque>
+#include <tuple>
 
 namespace ndn {
 namespace ndnabac {
@@ -31,18 +36,86 @@ namespace ndnabac {
 class AttributeAuthority
 {
 public:
+  /**
+   * @brief Constructor
+   *
+   * @param keyFile where the public parameters and master key are kept across restarts,
+   *        sealed with the key of @p identityCert (an RSA key), see AbeKeyFile.  The keys
+   *        are generated and saved there if the file does not exist yet; if empty, they
+   *        are generated on every start.
+   * @param nKeyGenWorkers number of threads generating decryption keys; 0 means one per
+   *        hardware thread
+   * @param maxQueuedKeyRequests the most DKEY requests waiting for a worker; further
+   *        requests are answered with an application-level Nack
+   * @throw AbeKeyFile::Error @p keyFile exists but cannot be loaded
+   */
   AttributeAuthority(const security::v2::Certificate& identityCert, Face& m_face,
-                     security::v2::KeyChain& keyChain);
+                     security::v2::KeyChain& keyChain,
+                     const std::string& keyFile = "",
+                     size_t nKeyGenWorkers = 0,
+                     size_t maxQueuedKeyRequests = DEFAULT_MAX_QUEUED_KEY_REQUESTS);
 
   ~AttributeAuthority();
 
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /**
+   * @brief A DKEY request waiting for a key generation worker
+   */
+  struct KeyRequest
+  {
+    Interest interest;
+    security::v2::Certificate consumerCert;
+    std::vector<std::string> attrs;
+  };
+
+  /**
+   * @brief A key issued to a consumer key for a version of its attribute set, which is
+   *        the attribute set itself
+   */
+  using IssuedKeyId = std::tuple<Name/* Consumer Identity */, std::vector<std::string>/* Attr */,
+                                 Name/* Consumer Key */>;
+
+  static IssuedKeyId
+  getIssuedKeyId(const KeyRequest& keyRequest);
+
+  /**
+   * @brief Answer a DKEY request from m_issuedKeys, or queue it, or Nack it if the queue
+   *        is full
+   *
+   * Key generation, wrapping and the check of the request signature run on
+   * m_keyGenPool; the reply is signed and sent on the face's thread.
+   */
   void
   onDecryptionKeyRequest(const Interest& interest);
 
+  /**
+   * @brief Hand queued requests to idle workers, taking one from each consumer in turn
+   */
+  void
+  dispatchKeyRequests();
+
+  /**
+   * @brief Called on the face's thread when a worker is done with a request
+   * @param content the wrapped key, or an empty block if the request is rejected
+   */
+  void
+  onKeyGenerated(const KeyRequest& keyRequest, const Block& content);
+
+  void
+  sendKey(const Interest& interest, const Block& content);
+
+  void
+  sendNack(const Interest& interest);
+
   void
   onPublicParamsRequest(const Interest& interest);
 
+  /**
+   * @brief Sign the public parameters once, as /<AA>/PUBPARAMS/<digest of the parameters>
+   */
+  void
+  makePublicParamsData();
+
   void
   onRegisterFailed(const std::string& reason);
 
@@ -52,6 +125,7 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
 public:
   const static Name PUBLIC_PARAMS;
   const static Name DECRYPT_KEY;
+  const static size_t DEFAULT_MAX_QUEUED_KEY_REQUESTS;
 
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   security::v2::Certificate m_cert;
@@ -59,12 +133,25 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   security::v2::KeyChain& m_keyChain;
 
   algo::PublicParams m_pubParams;
+  Data m_pubParamsData;
   algo::MasterKey m_masterKey;
 
   TrustConfig m_trustConfig;
 
   std::map<Name/* Consumer Identity */, std::list<std::string>/* Attr */> m_tokens;
 
+  shared_ptr<ThreadPool> m_keyGenPool;
+  size_t m_maxQueuedKeyRequests;
+  std::map<Name/* Consumer Identity */, std::deque<KeyRequest>> m_keyRequests;
+  std::deque<Name/* Consumer Identity */> m_keyRequestRound; // consumers with queued requests
+  size_t m_nQueuedKeyRequests = 0;
+  size_t m_nRunningKeyRequests = 0;
+  // wrapped keys, so that a consumer asking again costs no pairing work; a change of
+  // the attributes of a consumer changes the id, so stale keys are never found
+  LruCache<IssuedKeyId, Block/* encrypted private key */> m_issuedKeys;
+  // reset on destruction, so that results of running workers are dropped
+  shared_ptr<bool> m_isAlive = make_shared<bool>(true);
+
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   std::list<RegisteredPrefixHandle> m_registeredPrefixIds;
   std::list<InterestFilterHandle> m_interestFilterIds;
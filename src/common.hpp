@@ -99,6 +99,10 @@ const uint32_t TLV_EncryptedContent = 602;
 const uint32_t TLV_PlainTextSize = 603;
 const uint32_t TLV_AesKeyId = 604;
 const uint32_t TLV_InitialVector = 605;
+const uint32_t TLV_CipherSuite = 606;
+const uint32_t TLV_ChunkSize = 607;
+const uint32_t TLV_PublicParams = 608;
+const uint32_t TLV_MasterKey = 609;
 
 } // namespace ndnabac
 } // namespace ndn
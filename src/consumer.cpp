@@ -32,16 +32,23 @@ namespace ndnabac {
 
 NDN_LOG_INIT(ndnabac.consumer);
 
+const size_t Consumer::DEFAULT_CK_CACHE_CAPACITY = 1024;
+const time::nanoseconds Consumer::DEFAULT_CK_LIFETIME = time::hours(1);
+
 // public
 Consumer::Consumer(const security::v2::Certificate& identityCert,
                    Face& face, security::v2::KeyChain& keyChain,
                    const Name& attrAuthorityPrefix,
-                   uint8_t repeatAttempts)
+                   uint8_t repeatAttempts,
+                   size_t ckCacheCapacity,
+                   time::nanoseconds ckLifetime)
   : m_cert(identityCert)
   , m_face(face)
   , m_keyChain(keyChain)
   , m_attrAuthorityPrefix(attrAuthorityPrefix)
   , m_repeatAttempts(repeatAttempts)
+  , m_ckCache(ckCacheCapacity)
+  , m_ckLifetime(ckLifetime)
 {
   fetchPublicParams();
 }
@@ -72,35 +79,435 @@ Consumer::decryptContent(const Data& data, const Name& tokenIssuerPrefix,
 
   NDN_LOG_INFO(m_cert.getIdentity()<<" get data "<<data.getName()<<" from producer" );
   Block encryptedContent = data.getContent();
+  encryptedContent.parse();
+
+  if (encryptedContent.find(tlv::Name) == encryptedContent.elements_end()) {
+    // the whole cipher text in the Data, ABE-decrypted every time
+    algo::CipherText cipherText;
+    try {
+      cipherText.wireDecode(encryptedContent);
+    }
+    catch (const tlv::Error& e) {
+      errorCallback(std::string("Malformed content: ") + e.what());
+      return;
+    }
+    decryptCipherText(cipherText, tokenIssuerPrefix, successCallBack, errorCallback);
+    return;
+  }
+
+  if (encryptedContent.find(TLV_EncryptedAesKey) != encryptedContent.elements_end()) {
+    // content key wrapped under a KEK, which is published ABE-encrypted as CK Data; both
+    // are authenticated with the KEK name
+    Name kekName;
+    try {
+      kekName.wireDecode(encryptedContent.get(tlv::Name));
+    }
+    catch (const tlv::Error& e) {
+      errorCallback(std::string("Malformed content: ") + e.what());
+      return;
+    }
+    fetchContentKey(kekName, tokenIssuerPrefix,
+                    [=] (const Buffer& kek) {
+                      Buffer result;
+                      try {
+                        result = decryptDataContentWithKek(encryptedContent, kek.data(), kek.size());
+                      }
+                      catch (const std::exception& e) {
+                        errorCallback(std::string("Cannot decrypt: ") + e.what());
+                        return;
+                      }
+                      successCallBack(result);
+                    },
+                    errorCallback);
+    return;
+  }
+
+  // content encrypted directly under the content key of the CK Data it names
+  auto cipherText = make_shared<algo::CipherText>();
+  Name ckName;
+  try {
+    ckName = cipherText->wireDecodeDataContent(encryptedContent);
+  }
+  catch (const tlv::Error& e) {
+    errorCallback(std::string("Malformed content: ") + e.what());
+    return;
+  }
+  fetchContentKey(ckName, tokenIssuerPrefix,
+                  [=] (const Buffer& contentKey) {
+                    Buffer result;
+                    try {
+                      result = algo::ABESupport::decryptContent(*cipherText, contentKey);
+                    }
+                    catch (const std::exception& e) {
+                      errorCallback(std::string("Cannot decrypt: ") + e.what());
+                      return;
+                    }
+                    successCallBack(result);
+                  },
+                  errorCallback);
+}
+
+void
+Consumer::consumeRange(const Name& dataName, const Name& tokenIssuerPrefix,
+                       size_t offset, size_t length,
+                       const ConsumptionCallback& consumptionCb,
+                       const ErrorCallback& errorCallback)
+{
+  Interest interest(dataName);
+  interest.setMustBeFresh(true);
+
+  DataCallback dataCb = std::bind(&Consumer::decryptContentRange, this, _2, tokenIssuerPrefix,
+                                  offset, length, consumptionCb, errorCallback);
+
+  NDN_LOG_INFO(m_cert.getIdentity() << " asking for bytes " << offset << "+" << length
+               << " of " << interest.getName());
+  m_face.expressInterest(interest, dataCb,
+                         std::bind(&Consumer::handleNack, this, _1, _2, errorCallback),
+                         std::bind(&Consumer::handleTimeout, this, _1, m_repeatAttempts, dataCb, errorCallback));
+}
+
+void
+Consumer::decryptContentRange(const Data& data, const Name& tokenIssuerPrefix,
+                              size_t offset, size_t length,
+                              const ConsumptionCallback& successCallBack,
+                              const ErrorCallback& errorCallback)
+{
+  auto cipherText = make_shared<algo::CipherText>();
+  Name ckName;
+  try {
+    ckName = cipherText->wireDecodeDataContent(data.getContent());
+  }
+  catch (const tlv::Error& e) {
+    errorCallback(std::string("Malformed content: ") + e.what());
+    return;
+  }
+  if (cipherText->m_suite != algo::CipherSuite::AES_256_GCM_CHUNKED) {
+    errorCallback("Content is not chunked");
+    return;
+  }
+  fetchContentKey(ckName, tokenIssuerPrefix,
+                  [=] (const Buffer& contentKey) {
+                    Buffer result;
+                    try {
+                      result = algo::ABESupport::decryptContentRange(*cipherText, contentKey,
+                                                                     offset, length);
+                    }
+                    catch (const std::exception& e) {
+                      errorCallback(std::string("Cannot decrypt: ") + e.what());
+                      return;
+                    }
+                    successCallBack(result);
+                  },
+                  errorCallback);
+}
+
+void
+Consumer::consumeSegmented(const Name& dataName, const Name& tokenIssuerPrefix,
+                           const ConsumptionCallback& segmentCb,
+                           const CompletionCallback& completionCb,
+                           const ErrorCallback& errorCallback,
+                           const util::SegmentFetcher::Options& options)
+{
+  auto object = make_shared<SegmentedObject>();
+  object->tokenIssuerPrefix = tokenIssuerPrefix;
+  object->segmentCb = segmentCb;
+  object->completionCb = completionCb;
+  object->errorCallback = errorCallback;
+
+  Interest interest(dataName);
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+
+  NDN_LOG_INFO(m_cert.getIdentity() << " fetching segments of " << dataName);
+  // the fetcher keeps itself alive until it completes or fails, and with it these
+  // handlers and the object
+  auto fetcher = util::SegmentFetcher::start(m_face, interest, m_segmentValidator, options);
+  object->fetcher = fetcher;
+  fetcher->afterSegmentValidated.connect([=] (const Data& segment) {
+      onSegment(object, segment);
+    });
+  fetcher->onComplete.connect([=] (const ConstBufferPtr&) {
+      object->isFetched = true;
+      deliverSegments(object);
+    });
+  fetcher->onError.connect([=] (uint32_t, const std::string& reason) {
+      failSegmented(object, "Cannot fetch segments: " + reason);
+    });
+}
+
+void
+Consumer::onSegment(const shared_ptr<SegmentedObject>& object, const Data& segment)
+{
+  if (object->hasFailed) {
+    return;
+  }
+
   algo::CipherText cipherText;
-  cipherText.wireDecode(encryptedContent);
+  Name ckName;
+  try {
+    ckName = cipherText.wireDecodeDataContent(segment.getContent());
+  }
+  catch (const tlv::Error& e) {
+    failSegmented(object, std::string("Malformed segment: ") + e.what());
+    return;
+  }
+  if (cipherText.m_suite != algo::CipherSuite::AES_256_GCM) {
+    failSegmented(object, "Unexpected cipher suite in segment");
+    return;
+  }
+  const auto& segmentComponent = segment.getName().get(-1);
+  auto finalBlockId = segment.getFinalBlock();
+  bool isLast = finalBlockId && *finalBlockId == segmentComponent;
+  object->encrypted[segmentComponent.toSegment()] = {std::move(cipherText), isLast};
 
-  auto it = m_keyCache.find(tokenIssuerPrefix);
-  if (it == m_keyCache.end()) {
-    NDN_LOG_INFO(m_cert.getIdentity()<<" Private key is not there: we need to fetch token and private key");
+  if (object->ckName.empty()) {
+    object->ckName = ckName;
+    fetchContentKey(ckName, object->tokenIssuerPrefix,
+                    std::bind(&Consumer::onSegmentKey, this, object, _1),
+                    std::bind(&Consumer::failSegmented, this, object, _1));
+  }
+  else if (ckName != object->ckName) {
+    failSegmented(object, "Segments are encrypted under different content keys");
+    return;
+  }
+  deliverSegments(object);
+}
+
+void
+Consumer::onSegmentKey(const shared_ptr<SegmentedObject>& object, const Buffer& contentKey)
+{
+  object->contentKey = contentKey;
+  deliverSegments(object);
+}
 
-    Name requestTokenName = tokenIssuerPrefix;
-    requestTokenName.append(TokenIssuer::TOKEN_REQUEST);
-    requestTokenName.append(m_cert.getIdentity().wireEncode());
-    Interest interest(requestTokenName);
-    m_keyChain.sign(interest, signingByCertificate(m_cert));
-    interest.setMustBeFresh(true);
+void
+Consumer::deliverSegments(const shared_ptr<SegmentedObject>& object)
+{
+  if (object->hasFailed || object->contentKey.empty()) {
+    return;
+  }
+
+  // the segment number and the last-segment flag are authenticated with the payload, so
+  // a segment served under another name, or a forged end of the object, fails here
+  for (const auto& segment : object->encrypted) {
+    const auto& content = segment.second.cipherText.m_content;
+    bool isLast = segment.second.isLast;
+    try {
+      object->decrypted[segment.first] =
+        algo::ABESupport::aes_256_gcm_decrypt(content.data(), content.size(), object->contentKey,
+                                              algo::ABESupport::makeSegmentAad(segment.first,
+                                                                               isLast));
+    }
+    catch (const algo::ABESupport::Error& e) {
+      failSegmented(object, "Cannot decrypt segment " + std::to_string(segment.first) + ": " +
+                    e.what());
+      return;
+    }
+    if (isLast) {
+      object->nSegments = segment.first + 1;
+    }
+  }
+  object->encrypted.clear();
 
-    DataCallback dataCb = std::bind(&Consumer::onTokenData, this, _2, tokenIssuerPrefix, cipherText,
-                                    successCallBack, errorCallback);
+  auto it = object->decrypted.begin();
+  while (it != object->decrypted.end() && it->first == object->nextSegment) {
+    object->segmentCb(it->second);
+    it = object->decrypted.erase(it);
+    ++object->nextSegment;
+  }
 
-    NDN_LOG_INFO(m_cert.getIdentity()<<"Request token:"<<interest.getName());
-    m_face.expressInterest(interest, dataCb,
-                           std::bind(&Consumer::handleNack, this, _1, _2, errorCallback),
-                           std::bind(&Consumer::handleTimeout, this, _1, m_repeatAttempts, dataCb, errorCallback));
+  if (object->isFetched && object->decrypted.empty()) {
+    if (object->nextSegment != object->nSegments) {
+      failSegmented(object, "Segmented object ends before its last segment");
+      return;
+    }
+    NDN_LOG_DEBUG(m_cert.getIdentity() << " consumed " << object->nextSegment << " segments");
+    object->completionCb();
   }
-  else {
-    algo::PrivateKey prvKey;
+}
+
+void
+Consumer::failSegmented(const shared_ptr<SegmentedObject>& object, const std::string& reason)
+{
+  if (object->hasFailed) {
+    return;
+  }
+  object->hasFailed = true;
+  auto fetcher = object->fetcher.lock();
+  if (fetcher != nullptr) {
+    fetcher->stop();
+  }
+  object->errorCallback(reason);
+}
+
+void
+Consumer::fetchContentKey(const Name& ckName, const Name& tokenIssuerPrefix,
+                          const ConsumptionCallback& keyCallback,
+                          const ErrorCallback& errorCallback)
+{
+  auto cached = m_ckCache.find(ckName);
+  if (cached != nullptr) {
+    if (time::steady_clock::now() < cached->expiry) {
+      keyCallback(cached->key);
+      return;
+    }
+    m_ckCache.erase(ckName);
+  }
+
+  // one fetch and one ABE decryption per CK, whatever number of packets wait for it
+  auto& pending = m_pendingCks[ckName];
+  pending.push_back({keyCallback, errorCallback});
+  if (pending.size() > 1) {
+    return;
+  }
+
+  Interest interest(ckName);
+  interest.setCanBePrefix(true);
+
+  DataCallback dataCb = std::bind(&Consumer::onCkData, this, _2, ckName, tokenIssuerPrefix);
+  ErrorCallback ckErrorCallback = std::bind(&Consumer::onContentKeyError, this, ckName, _1);
+
+  NDN_LOG_INFO(m_cert.getIdentity()<<" Request CK:"<<interest.getName());
+  m_face.expressInterest(interest, dataCb,
+                         std::bind(&Consumer::handleNack, this, _1, _2, ckErrorCallback),
+                         std::bind(&Consumer::handleTimeout, this, _1, m_repeatAttempts, dataCb, ckErrorCallback));
+}
+
+void
+Consumer::onCkData(const Data& ckData, const Name& ckName, const Name& tokenIssuerPrefix)
+{
+  ErrorCallback errorCallback = std::bind(&Consumer::onContentKeyError, this, ckName, _1);
+
+  Block content = ckData.getContent();
+  content.parse();
+  auto ckCipherText = make_shared<algo::CipherText>();
+  try {
+    if (content.find(TLV_EncryptedContent) != content.elements_end()) {
+      // a KEK or content key ABE-encrypted as a whole (Producer::makeKek)
+      ckCipherText->wireDecode(content);
+      decryptCipherText(*ckCipherText, tokenIssuerPrefix,
+                        std::bind(&Consumer::onContentKey, this, ckName, _1), errorCallback);
+      return;
+    }
+    ckCipherText->wireDecodeCKContent(content);
+  }
+  catch (const tlv::Error& e) {
+    errorCallback(std::string("Malformed CK Data: ") + e.what());
+    return;
+  }
+
+  // only the ABE-encrypted key, from which the content key is derived
+  getPrivateKey(tokenIssuerPrefix,
+                [=] (const algo::DecodedPrivateKey& prvKey) {
+                  Buffer contentKey;
+                  try {
+                    contentKey = algo::ABESupport::decryptContentKey(prvKey, *ckCipherText);
+                  }
+                  catch (const std::exception& e) {
+                    errorCallback(std::string("Cannot decrypt: ") + e.what());
+                    return;
+                  }
+                  onContentKey(ckName, contentKey);
+                },
+                errorCallback);
+}
+
+void
+Consumer::onContentKey(const Name& ckName, const Buffer& contentKey)
+{
+  // a CK name stands for one key, so a live entry is never replaced by another key
+  auto cached = m_ckCache.find(ckName);
+  if (cached == nullptr || time::steady_clock::now() >= cached->expiry) {
+    m_ckCache.insert(ckName, {contentKey, time::steady_clock::now() + m_ckLifetime});
+  }
+  else if (cached->key != contentKey) {
+    NDN_LOG_WARN(m_cert.getIdentity() << " got another key for cached CK " << ckName
+                 << ", keeping the cached one");
+  }
+
+  auto it = m_pendingCks.find(ckName);
+  if (it == m_pendingCks.end()) {
+    return;
+  }
+  auto pending = std::move(it->second);
+  m_pendingCks.erase(it);
+  NDN_LOG_DEBUG(m_cert.getIdentity() << " recovered CK " << ckName << " for "
+                << pending.size() << " waiting packets");
+  for (const auto& waiting : pending) {
+    waiting.keyCallback(contentKey);
+  }
+}
+
+void
+Consumer::onContentKeyError(const Name& ckName, const std::string& reason)
+{
+  auto it = m_pendingCks.find(ckName);
+  if (it == m_pendingCks.end()) {
+    return;
+  }
+  auto pending = std::move(it->second);
+  m_pendingCks.erase(it);
+  for (const auto& waiting : pending) {
+    waiting.errorCallback(reason);
+  }
+}
+
+void
+Consumer::getPrivateKey(const Name& tokenIssuerPrefix, const PrivateKeyCallback& keyCallback,
+                        const ErrorCallback& errorCallback)
+{
+  auto it = m_keyCache.find(tokenIssuerPrefix);
+  if (it != m_keyCache.end()) {
+    shared_ptr<algo::DecodedPrivateKey> prvKey;
     std::tie(std::ignore, prvKey) = it->second;
+    keyCallback(*prvKey);
+    return;
+  }
+
+  NDN_LOG_INFO(m_cert.getIdentity()<<" Private key is not there: we need to fetch token and private key");
+
+  Name requestTokenName = tokenIssuerPrefix;
+  requestTokenName.append(TokenIssuer::TOKEN_REQUEST);
+  requestTokenName.append(m_cert.getIdentity().wireEncode());
+  Interest interest(requestTokenName);
+  m_keyChain.sign(interest, signingByCertificate(m_cert));
+  interest.setMustBeFresh(true);
+
+  DataCallback dataCb = std::bind(&Consumer::onTokenData, this, _2, tokenIssuerPrefix,
+                                  keyCallback, errorCallback);
+
+  NDN_LOG_INFO(m_cert.getIdentity()<<"Request token:"<<interest.getName());
+  m_face.expressInterest(interest, dataCb,
+                         std::bind(&Consumer::handleNack, this, _1, _2, errorCallback),
+                         std::bind(&Consumer::handleTimeout, this, _1, m_repeatAttempts, dataCb, errorCallback));
+}
+
+void
+Consumer::decryptCipherText(const algo::CipherText& cipherText, const Name& tokenIssuerPrefix,
+                            const ConsumptionCallback& successCallBack,
+                            const ErrorCallback& errorCallback)
+{
+  getPrivateKey(tokenIssuerPrefix,
+                [=] (const algo::DecodedPrivateKey& prvKey) {
+                  decryptWithKey(prvKey, cipherText, successCallBack, errorCallback);
+                },
+                errorCallback);
+}
 
-    Buffer result = algo::ABESupport::decrypt(m_pubParamsCache, prvKey, cipherText);
-    successCallBack(result);
+void
+Consumer::decryptWithKey(const algo::DecodedPrivateKey& prvKey, const algo::CipherText& cipherText,
+                         const ConsumptionCallback& successCallBack,
+                         const ErrorCallback& errorCallback)
+{
+  Buffer result;
+  try {
+    result = algo::ABESupport::decrypt(prvKey, cipherText);
   }
+  catch (const std::exception& e) {
+    errorCallback(std::string("Cannot decrypt: ") + e.what());
+    return;
+  }
+  successCallBack(result);
 }
 
 void
@@ -108,11 +515,9 @@ Consumer::onAttributePubParams(const Interest& request, const Data& pubParamData
 {
   NDN_LOG_INFO(m_cert.getIdentity()<<" Get public parameters");
   Name attrAuthorityKey = pubParamData.getSignature().getKeyLocator().getName();
-  for (auto anchor : m_trustConfig.m_trustAnchors) {
-    if (anchor.getKeyName() == attrAuthorityKey) {
-      BOOST_ASSERT(security::verifySignature(pubParamData, anchor));
-      break;
-    }
+  auto anchor = m_trustConfig.findByKeyName(attrAuthorityKey);
+  if (anchor != nullptr) {
+    BOOST_ASSERT(security::verifySignature(pubParamData, *anchor));
   }
 
   auto block = pubParamData.getContent();
@@ -120,8 +525,8 @@ Consumer::onAttributePubParams(const Interest& request, const Data& pubParamData
 }
 
 void
-Consumer::onTokenData(const Data& tokenData, const Name& tokenIssuerPrefix, algo::CipherText cipherText,
-                      const ConsumptionCallback& successCallBack,
+Consumer::onTokenData(const Data& tokenData, const Name& tokenIssuerPrefix,
+                      const PrivateKeyCallback& keyCallback,
                       const ErrorCallback& errorCallback)
 {
   NDN_LOG_INFO(m_cert.getIdentity()<<" get token data");
@@ -131,33 +536,40 @@ Consumer::onTokenData(const Data& tokenData, const Name& tokenIssuerPrefix, algo
   Interest interest(interestName);
   interest.setMustBeFresh(true);
 
-  DataCallback dataCb = std::bind(&Consumer::onDecryptionKeyData, this, _2, tokenData,
-                                  tokenIssuerPrefix, cipherText, successCallBack, errorCallback);
+  DataCallback dataCb = std::bind(&Consumer::onDecryptionKeyData, this, _2,
+                                  tokenIssuerPrefix, keyCallback, errorCallback);
   m_face.expressInterest(interest, dataCb,
                          std::bind(&Consumer::handleNack, this, _1, _2, errorCallback),
                          std::bind(&Consumer::handleTimeout, this, _1, m_repeatAttempts, dataCb, errorCallback));
 }
 
 void
-Consumer::onDecryptionKeyData(const Data& keyData, const Data& tokenData,
-                              const Name& tokenIssuerPrefix, algo::CipherText cipherText,
-                              const ConsumptionCallback& successCallBack,
+Consumer::onDecryptionKeyData(const Data& keyData, const Name& tokenIssuerPrefix,
+                              const PrivateKeyCallback& keyCallback,
                               const ErrorCallback& errorCallback)
 {
   NDN_LOG_INFO(m_cert.getIdentity()<< " get decrypt key data");
+  if (keyData.getContentType() == tlv::ContentType_Nack) {
+    errorCallback("Attribute authority is busy, try again later");
+    return;
+  }
 
-  const auto& tpm = m_keyChain.getTpm();
-
-  const auto& block = keyData.getContent();
-  auto prvBlock = decryptDataContent(block, tpm, m_cert.getName());
-
-  algo::PrivateKey prv;
-  prv.fromBuffer(Buffer(prvBlock.data(), prvBlock.size()));
-
-  m_keyCache[tokenIssuerPrefix] = make_tuple(keyData, prv);
+  // decode and preprocess once here, every later decryption with this key reuses it;
+  // this fails, among others, if the public parameters have not arrived yet
+  shared_ptr<algo::DecodedPrivateKey> decodedKey;
+  try {
+    auto prvBlock = decryptDataContent(keyData.getContent(), m_keyChain.getTpm(), m_cert.getName());
+    algo::PrivateKey prv;
+    prv.fromBuffer(Buffer(prvBlock.data(), prvBlock.size()));
+    decodedKey = make_shared<algo::DecodedPrivateKey>(m_pubParamsCache, prv);
+  }
+  catch (const std::exception& e) {
+    errorCallback(std::string("Cannot decode the decryption key: ") + e.what());
+    return;
+  }
+  m_keyCache[tokenIssuerPrefix] = std::make_tuple(keyData, decodedKey);
 
-  Buffer result = algo::ABESupport::decrypt(m_pubParamsCache, prv, cipherText);
-  successCallBack(result);
+  keyCallback(*decodedKey);
 }
 
 void
@@ -189,6 +601,7 @@ Consumer::fetchPublicParams()
   Name interestName = m_attrAuthorityPrefix;
   interestName.append(AttributeAuthority::PUBLIC_PARAMS);
   Interest interest(interestName);
+  interest.setCanBePrefix(true);
   interest.setMustBeFresh(true);
 
   NDN_LOG_INFO(m_cert.getIdentity()<< " Requeset public parameters:"<<interest.getName());
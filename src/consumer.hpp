@@ -24,7 +24,12 @@
 #include "trust-config.hpp"
 #include "algo/public-params.hpp"
 #include "algo/private-key.hpp"
+#include "algo/decoded-private-key.hpp"
 #include "algo/cipher-text.hpp"
+#include "lru-cache.hpp"
+
+#include <ndn-cxx/security/validator-null.hpp>
+#include <ndn-cxx/util/segment-fetcher.hpp>
 
 namespace ndn {
 namespace ndnabac {
@@ -41,38 +46,160 @@ public:
   using OnDataCallback = function<void (const Interest&, const Data&)>;
   using ErrorCallback = function<void (const std::string&)>;
   using ConsumptionCallback = function<void (const Buffer&)>;
+  using CompletionCallback = function<void ()>;
 
 public:
+  /**
+   * @param ckCacheCapacity the number of content keys kept, by CK name
+   * @param ckLifetime how long a content key is kept after it has been recovered
+   */
   Consumer(const security::v2::Certificate& identityCert,
            Face& face, security::v2::KeyChain& keyChain,
            const Name& attrAuthorityPrefix,
-           uint8_t repeatAttempts = 3);
+           uint8_t repeatAttempts = 3,
+           size_t ckCacheCapacity = DEFAULT_CK_CACHE_CAPACITY,
+           time::nanoseconds ckLifetime = DEFAULT_CK_LIFETIME);
 
   void
   consume(const Name& dataName, const Name& tokenIssuerPrefix,
           const ConsumptionCallback& consumptionCb,
           const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Fetch an object produced by Producer::produceChunked and decrypt only bytes
+   *        [@p offset, @p offset + @p length) of it, cut short at its end
+   *
+   * Only the chunks that hold the range are decrypted.
+   */
+  void
+  consumeRange(const Name& dataName, const Name& tokenIssuerPrefix,
+               size_t offset, size_t length,
+               const ConsumptionCallback& consumptionCb,
+               const ErrorCallback& errorCallback);
+
+  /**
+   * @brief Fetch and decrypt an object produced by Producer::produceSegmented
+   *
+   * The segments of @p dataName (the latest version, unless @p dataName has one) are
+   * fetched by a window-based pipeline with AIMD congestion control, configured by
+   * @p options.  The content key is fetched once, as soon as the first segment names it;
+   * each segment is then decrypted as it arrives and passed to @p segmentCb in order.
+   * @p completionCb is called after the last segment.
+   */
+  void
+  consumeSegmented(const Name& dataName, const Name& tokenIssuerPrefix,
+                   const ConsumptionCallback& segmentCb, const CompletionCallback& completionCb,
+                   const ErrorCallback& errorCallback,
+                   const util::SegmentFetcher::Options& options = util::SegmentFetcher::Options());
+
+public:
+  static const size_t DEFAULT_CK_CACHE_CAPACITY;
+  static const time::nanoseconds DEFAULT_CK_LIFETIME;
+
 private:
+  using PrivateKeyCallback = function<void (const algo::DecodedPrivateKey&)>;
+
+  /**
+   * @brief State of one consumeSegmented call
+   */
+  struct SegmentedObject
+  {
+    Name tokenIssuerPrefix;
+    ConsumptionCallback segmentCb;
+    CompletionCallback completionCb;
+    ErrorCallback errorCallback;
+
+    struct EncryptedSegment
+    {
+      algo::CipherText cipherText;
+      bool isLast; // whether the segment claims to be the last one
+    };
+
+    weak_ptr<util::SegmentFetcher> fetcher;
+    Name ckName;
+    Buffer contentKey;
+    std::map<uint64_t, EncryptedSegment> encrypted; // waiting for the content key
+    std::map<uint64_t, Buffer> decrypted; // waiting for earlier segments
+    uint64_t nextSegment = 0;
+    uint64_t nSegments = 0; // known once the last segment has been authenticated
+    bool isFetched = false;
+    bool hasFailed = false;
+  };
+
+  void
+  onSegment(const shared_ptr<SegmentedObject>& object, const Data& segment);
+
+  void
+  onSegmentKey(const shared_ptr<SegmentedObject>& object, const Buffer& contentKey);
+
+  /**
+   * @brief Decrypt the segments waiting for the key, then pass on those next in order
+   */
+  void
+  deliverSegments(const shared_ptr<SegmentedObject>& object);
+
+  void
+  failSegmented(const shared_ptr<SegmentedObject>& object, const std::string& reason);
+
+  /**
+   * @brief Get the content key published as CK Data under @p ckName
+   *
+   * The key comes from the cache if possible.  Otherwise the CK Data is fetched and
+   * ABE-decrypted once, however many callers ask for it in the meantime.
+   */
+  void
+  fetchContentKey(const Name& ckName, const Name& tokenIssuerPrefix,
+                  const ConsumptionCallback& keyCallback, const ErrorCallback& errorCallback);
+
+  void
+  onCkData(const Data& ckData, const Name& ckName, const Name& tokenIssuerPrefix);
+
+  void
+  onContentKey(const Name& ckName, const Buffer& contentKey);
+
+  void
+  onContentKeyError(const Name& ckName, const std::string& reason);
+
+  /**
+   * @brief Get the decoded private key from @p tokenIssuerPrefix, fetching the token and
+   *        the key from the attribute authority the first time
+   */
+  void
+  getPrivateKey(const Name& tokenIssuerPrefix, const PrivateKeyCallback& keyCallback,
+                const ErrorCallback& errorCallback);
+
   void
   decryptContent(const Data& data, const Name& tokenIssuerPrefix,
                  const ConsumptionCallback& successCallBack,
                  const ErrorCallback& errorCallback);
 
+  void
+  decryptContentRange(const Data& data, const Name& tokenIssuerPrefix,
+                      size_t offset, size_t length,
+                      const ConsumptionCallback& successCallBack,
+                      const ErrorCallback& errorCallback);
+
+  void
+  decryptCipherText(const algo::CipherText& cipherText, const Name& tokenIssuerPrefix,
+                    const ConsumptionCallback& successCallBack,
+                    const ErrorCallback& errorCallback);
+
+  void
+  decryptWithKey(const algo::DecodedPrivateKey& prvKey, const algo::CipherText& cipherText,
+                 const ConsumptionCallback& successCallBack,
+                 const ErrorCallback& errorCallback);
+
   void
   onAttributePubParams(const Interest& request, const Data& pubParamData);
 
 
   void
-  onTokenData(const Data& tokenData, const Name& tokenIssuerPrefix, algo::CipherText cipherText,
-              const ConsumptionCallback& successCallBack,
-              const ErrorCallback& errorCallback);
+  onTokenData(const Data& tokenData, const Name& tokenIssuerPrefix,
+              const PrivateKeyCallback& keyCallback, const ErrorCallback& errorCallback);
 
   void
-  onDecryptionKeyData(const Data& keyData, const Data& tokenData,
-                      const Name& tokenIssuerPrefix, algo::CipherText cipherText,
-                      const ConsumptionCallback& successCallBack,
-                      const ErrorCallback& errorCallback);
+  onDecryptionKeyData(const Data& keyData, const Name& tokenIssuerPrefix,
+                      const PrivateKeyCallback& keyCallback, const ErrorCallback& errorCallback);
 
   void
   handleNack(const Interest& interest, const lp::Nack& nack,
@@ -95,7 +222,25 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   algo::PublicParams m_pubParamsCache;
   TrustConfig m_trustConfig;
   std::map<Name/*tokenIssuerPrefix*/,
-           std::tuple<Data/*token*/, algo::PrivateKey>> m_keyCache;
+           std::tuple<Data/*token*/, shared_ptr<algo::DecodedPrivateKey>>> m_keyCache;
+
+  struct CachedContentKey
+  {
+    Buffer key;
+    time::steady_clock::time_point expiry;
+  };
+
+  struct PendingContentKey
+  {
+    ConsumptionCallback keyCallback;
+    ErrorCallback errorCallback;
+  };
+
+  // content keys and KEKs
+  LruCache<Name/*CK name*/, CachedContentKey> m_ckCache;
+  time::nanoseconds m_ckLifetime;
+  std::map<Name/*CK name*/, std::vector<PendingContentKey>> m_pendingCks;
+  security::v2::ValidatorNull m_segmentValidator;
 };
 
 } // namespace ndnabac
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "data-store.hpp"
+
+namespace ndn {
+namespace ndnabac {
+
+DataStore::DataStore(size_t capacity)
+  : m_capacity(capacity)
+{
+  BOOST_ASSERT(capacity > 0);
+}
+
+bool
+DataStore::insert(const Data& data, const Name& keyName)
+{
+  size_t dataSize = data.wireEncode().size();
+  if (dataSize > m_capacity) {
+    return false;
+  }
+  // a replaced packet keeps its dependents
+  auto existing = m_index.find(data.getName());
+  if (existing != m_index.end()) {
+    eraseEntry(existing);
+  }
+
+  while (m_bytes + dataSize > m_capacity) {
+    Name victim = m_entries.back().data->getName();
+    erase(victim);
+  }
+  m_entries.push_front(Entry{make_shared<const Data>(data), keyName});
+  m_index[data.getName()] = m_entries.begin();
+  m_bytes += dataSize;
+  if (!keyName.empty()) {
+    m_dependents.emplace(keyName, data.getName());
+  }
+  return true;
+}
+
+const Data*
+DataStore::find(const Interest& interest)
+{
+  const Name& name = interest.getName();
+  auto it = m_index.lower_bound(name);
+  if (interest.getCanBePrefix()) {
+    for (; it != m_index.end() && name.isPrefixOf(it->first); ++it) {
+      if (interest.matchesData(*it->second->data)) {
+        break;
+      }
+    }
+    if (it != m_index.end() && !name.isPrefixOf(it->first)) {
+      it = m_index.end();
+    }
+  }
+  else if (it != m_index.end() && it->first != name) {
+    it = m_index.end();
+  }
+  if (it == m_index.end()) {
+    return nullptr;
+  }
+
+  // the key goes first, so that it is evicted after its most recently served dependent
+  const Name& keyName = it->second->keyName;
+  if (!keyName.empty()) {
+    for (auto key = m_index.lower_bound(keyName);
+         key != m_index.end() && keyName.isPrefixOf(key->first); ++key) {
+      m_entries.splice(m_entries.begin(), m_entries, key->second);
+    }
+  }
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->data.get();
+}
+
+bool
+DataStore::erase(const Name& name)
+{
+  auto it = m_index.find(name);
+  bool isStored = it != m_index.end();
+  if (isStored) {
+    eraseEntry(it);
+  }
+  eraseDependents(name);
+  return isStored;
+}
+
+void
+DataStore::eraseEntry(Index::iterator it)
+{
+  const Entry& entry = *it->second;
+  if (!entry.keyName.empty()) {
+    auto range = m_dependents.equal_range(entry.keyName);
+    for (auto dependent = range.first; dependent != range.second; ++dependent) {
+      if (dependent->second == it->first) {
+        m_dependents.erase(dependent);
+        break;
+      }
+    }
+  }
+  m_bytes -= entry.data->wireEncode().size();
+  m_entries.erase(it->second);
+  m_index.erase(it);
+}
+
+void
+DataStore::eraseDependents(const Name& name)
+{
+  std::vector<Name> dependents;
+  for (size_t i = 1; i <= name.size(); i++) {
+    auto range = m_dependents.equal_range(name.getPrefix(i));
+    for (auto dependent = range.first; dependent != range.second; ++dependent) {
+      dependents.push_back(dependent->second);
+    }
+  }
+  for (const auto& dependent : dependents) {
+    erase(dependent);
+  }
+}
+
+} // namespace ndnabac
+} // namespace ndn
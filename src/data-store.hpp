@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_DATA_STORE_HPP
+#define NDNABAC_DATA_STORE_HPP
+
+#include "common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+
+/**
+ * @brief Signed Data packets kept in memory up to a number of bytes, evicting the least
+ *        recently served packets first
+ *
+ * A packet is accounted at the size of its wire encoding.  A packet may depend on a key,
+ * such as the CK Data needed to decrypt it: evicting or erasing the key's packet erases
+ * its dependents too, and serving a dependent refreshes its key.  Not thread-safe.
+ */
+class DataStore : noncopyable
+{
+public:
+  /**
+   * @param capacity the most bytes of wire encoding kept, which must be positive
+   */
+  explicit
+  DataStore(size_t capacity);
+
+  /**
+   * @brief Insert or replace @p data, evicting least recently served packets to fit it
+   * @param keyName if not empty, @p data is erased with any packet under @p keyName;
+   *                insert @p data before that packet, so that fitting it cannot evict the key
+   * @pre @p data is signed
+   * @return false, and nothing is stored, if @p data alone is larger than the capacity
+   */
+  bool
+  insert(const Data& data, const Name& keyName = Name());
+
+  /**
+   * @brief Find a packet satisfying @p interest
+   * @return the packet, or nullptr
+   * @post the packet, if found, becomes the most recently served one
+   */
+  const Data*
+  find(const Interest& interest);
+
+  /**
+   * @brief Erase the packet named @p name, if any, and the packets depending on a key
+   *        that is a prefix of @p name, whether or not that packet is stored
+   * @return whether a packet named @p name was stored
+   */
+  bool
+  erase(const Name& name);
+
+  size_t
+  size() const
+  {
+    return m_index.size();
+  }
+
+  size_t
+  getBytes() const
+  {
+    return m_bytes;
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+private:
+  struct Entry
+  {
+    shared_ptr<const Data> data;
+    Name keyName; // empty if the packet depends on no key
+  };
+  using Entries = std::list<Entry>;
+  using Index = std::map<Name, Entries::iterator>;
+
+  /**
+   * @brief Erase one packet, but not its dependents
+   */
+  void
+  eraseEntry(Index::iterator it);
+
+  void
+  eraseDependents(const Name& name);
+
+private:
+  size_t m_capacity;
+  size_t m_bytes = 0;
+  Entries m_entries; // most recently served first
+  Index m_index; // ordered, for prefix lookups
+  std::multimap<Name/* key name */, Name/* dependent */> m_dependents;
+};
+
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_DATA_STORE_HPP
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_LRU_CACHE_HPP
+#define NDNABAC_LRU_CACHE_HPP
+
+#include "common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+
+/**
+ * @brief A map bounded to a number of entries, evicting the least recently used one
+ *
+ * Not thread-safe; callers that share an instance across threads must lock around it.
+ */
+template<typename Key, typename Value>
+class LruCache : noncopyable
+{
+public:
+  explicit
+  LruCache(size_t capacity)
+    : m_capacity(capacity)
+  {
+    BOOST_ASSERT(capacity > 0);
+  }
+
+  /**
+   * @return the cached value, or nullptr if @p key is not cached
+   * @post @p key, if found, becomes the most recently used entry
+   */
+  Value*
+  find(const Key& key)
+  {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &it->second->second;
+  }
+
+  /**
+   * @brief Insert or replace the value for @p key, evicting the least recently used
+   *        entry if the cache is over capacity
+   * @return the stored value
+   */
+  Value&
+  insert(const Key& key, Value value)
+  {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      it->second->second = std::move(value);
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return it->second->second;
+    }
+
+    m_entries.emplace_front(key, std::move(value));
+    m_index.emplace(key, m_entries.begin());
+    if (m_entries.size() > m_capacity) {
+      m_index.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+    return m_entries.front().second;
+  }
+
+  bool
+  erase(const Key& key)
+  {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return false;
+    }
+    m_entries.erase(it->second);
+    m_index.erase(it);
+    return true;
+  }
+
+  void
+  clear()
+  {
+    m_index.clear();
+    m_entries.clear();
+  }
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  size_t
+  capacity() const
+  {
+    return m_capacity;
+  }
+
+private:
+  using EntryList = std::list<std::pair<Key, Value>>;
+
+  size_t m_capacity;
+  EntryList m_entries; // most recently used first
+  std::map<Key, typename EntryList::iterator> m_index;
+};
+
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_LRU_CACHE_HPP
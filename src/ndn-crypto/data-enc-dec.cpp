@@ -22,6 +22,9 @@
 #include "data-enc-dec.hpp"
 #include "aes.hpp"
 #include "rsa.hpp"
+#include "algo/abe-support.hpp"
+
+#include <ndn-cxx/util/random.hpp>
 
 namespace ndn {
 namespace ndnabac {
@@ -91,5 +94,83 @@ decryptDataContent(const Block& dataBlock, const security::Tpm& tpm, const Name&
   return payload;
 }
 
+namespace {
+
+Buffer
+makeKekAad(const Block& kekName)
+{
+  // the content is bound to the KEK it is wrapped under, so it cannot be moved under
+  // another KEK name
+  return Buffer(kekName.wire(), kekName.size());
+}
+
+Buffer
+toKek(const uint8_t* kek, size_t kekLen)
+{
+  if (kekLen != KEK_SIZE) {
+    BOOST_THROW_EXCEPTION(std::invalid_argument("KEK must be " + std::to_string(KEK_SIZE) +
+                                                " bytes, not " + std::to_string(kekLen)));
+  }
+  return Buffer(kek, kekLen);
+}
+
+} // namespace
+
+Block
+encryptDataContentWithKek(const uint8_t* payload, size_t payloadLen,
+                          const uint8_t* kek, size_t kekLen, const Name& kekName)
+{
+  Buffer aad = makeKekAad(kekName.wireEncode());
+
+  // per-object content key, never reused
+  Buffer aesKey(KEK_SIZE);
+  random::generateSecureBytes(aesKey.data(), aesKey.size());
+  auto encryptedAesKey = algo::ABESupport::aes_256_gcm_encrypt(aesKey.data(), aesKey.size(),
+                                                               toKek(kek, kekLen), aad);
+
+  size_t encryptedSize = algo::ABESupport::getAes256GcmEncryptedSize(payloadLen);
+  EncodingEstimator estimator;
+  size_t estimatedSize = kekName.wireEncode(estimator);
+  estimatedSize += estimator.prependByteArrayBlock(TLV_EncryptedAesKey,
+                                                   encryptedAesKey.data(), encryptedAesKey.size());
+  estimatedSize += estimator.prependVarNumber(encryptedSize) +
+                   estimator.prependVarNumber(TLV_EncryptedContent) + encryptedSize;
+  estimatedSize += estimator.prependVarNumber(estimatedSize);
+  estimatedSize += estimator.prependVarNumber(tlv::Content);
+
+  // the payload is encrypted in place, in the buffer of the block
+  EncodingBuffer buffer(estimatedSize, 0);
+  size_t totalLength = kekName.wireEncode(buffer);
+  totalLength += buffer.prependByteArrayBlock(TLV_EncryptedAesKey,
+                                              encryptedAesKey.data(), encryptedAesKey.size());
+  size_t payloadLength = algo::ABESupport::prependAes256GcmEncrypted(buffer, aesKey,
+                                                                     payload, payloadLen, aad);
+  payloadLength += buffer.prependVarNumber(payloadLength);
+  payloadLength += buffer.prependVarNumber(TLV_EncryptedContent);
+  totalLength += payloadLength;
+  totalLength += buffer.prependVarNumber(totalLength);
+  totalLength += buffer.prependVarNumber(tlv::Content);
+  return buffer.block();
+}
+
+Buffer
+decryptDataContentWithKek(const Block& dataBlock,
+                          const uint8_t* kek, size_t kekLen)
+{
+  dataBlock.parse();
+  const Block& encryptedAesKey = dataBlock.get(TLV_EncryptedAesKey);
+  const Block& encryptedPayload = dataBlock.get(TLV_EncryptedContent);
+  Buffer aad = makeKekAad(dataBlock.get(tlv::Name));
+
+  auto aesKey = algo::ABESupport::aes_256_gcm_decrypt(encryptedAesKey.value(),
+                                                      encryptedAesKey.value_size(),
+                                                      toKek(kek, kekLen), aad);
+  if (aesKey.size() != KEK_SIZE) {
+    BOOST_THROW_EXCEPTION(std::invalid_argument("Wrapped content key has a wrong size"));
+  }
+  return algo::ABESupport::aes_256_gcm_decrypt(encryptedPayload.value(),
+                                               encryptedPayload.value_size(), aesKey, aad);
+}
+
 }
 }
@@ -39,6 +39,33 @@ decryptDataContent(const Block& dataBlock,
 Buffer
 decryptDataContent(const Block& dataBlock, const security::Tpm& tpm, const Name& certName);
 
+/**
+ * Size of the symmetric key-encryption keys (KEKs) and of the content keys wrapped under
+ * them, both AES-256-GCM keys.
+ */
+const size_t KEK_SIZE = 32;
+
+/**
+ * Encrypt @p payload with a fresh AES-256-GCM content key and wrap that content key under
+ * the key-encryption key @p kek, also with AES-256-GCM.  Both are authenticated together
+ * with @p kekName, which is appended to the content after EncryptedContent and
+ * EncryptedAesKey.  The block is sized up front and encoded into a single buffer.
+ * @throw std::invalid_argument @p kekLen is not KEK_SIZE
+ */
+Block
+encryptDataContentWithKek(const uint8_t* payload, size_t payloadLen,
+                          const uint8_t* kek, size_t kekLen, const Name& kekName);
+
+/**
+ * @throw std::invalid_argument @p kekLen is not KEK_SIZE
+ * @throw tlv::Error @p dataBlock is malformed
+ * @throw algo::ABESupport::Error @p dataBlock fails authentication, e.g., under another
+ *        KEK name
+ */
+Buffer
+decryptDataContentWithKek(const Block& dataBlock,
+                          const uint8_t* kek, size_t kekLen);
+
 } // namespace ndnabac
 } // namespace ndn
 
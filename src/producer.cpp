@@ -20,6 +20,7 @@
 
 #include "producer.hpp"
 #include "attribute-authority.hpp"
+#include "ndn-crypto/data-enc-dec.hpp"
 #include <ndn-cxx/util/random.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/encoding/block-helpers.hpp>
@@ -31,20 +32,41 @@ namespace ndnabac {
 NDN_LOG_INIT(ndnabac.producer);
 
 const Name Producer::SET_POLICY = "/SET_POLICY";
+const name::Component Producer::CK("CK");
+const name::Component Producer::ENC_BY("ENC-BY");
+const size_t Producer::DEFAULT_SEGMENT_SIZE = 7000;
+const size_t Producer::DEFAULT_STORE_CAPACITY = 64 * 1024 * 1024;
+
+// content keys of segmented objects
+static const size_t CONTENT_KEY_SIZE = 32;
+
+// policy strings passed directly to produce(), not set through SET_POLICY
+static const size_t AD_HOC_POLICY_CACHE_SIZE = 256;
+
+static Buffer
+generateKey(size_t size)
+{
+  Buffer key(size);
+  random::generateSecureBytes(key.data(), key.size());
+  return key;
+}
+
 
 //public
 Producer::Producer(const security::v2::Certificate& identityCert, Face& face,
                    security::v2::KeyChain& keyChain, const Name& attrAuthorityPrefix,
-                   uint8_t repeatAttempts)
+                   uint8_t repeatAttempts, size_t storeCapacity)
   : m_cert(identityCert)
   , m_face(face)
   , m_keyChain(keyChain)
   , m_attrAuthorityPrefix(attrAuthorityPrefix)
   , m_repeatAttempts(repeatAttempts)
+  , m_adHocPolicies(AD_HOC_POLICY_CACHE_SIZE)
+  , m_store(storeCapacity)
 {
-  // prefix registration
-  auto filterId = m_face.setInterestFilter(Name(m_cert.getIdentity()).append(SET_POLICY),
-                                           bind(&Producer::onPolicyInterest, this, _2));
+  // one filter for policies, CK Data and produced Data, whatever the data prefixes
+  auto filterId = m_face.setInterestFilter(m_cert.getIdentity(),
+                                           bind(&Producer::onInterest, this, _2));
   NDN_LOG_DEBUG("set prefix:" << m_cert.getIdentity());
   m_interestFilterIds.push_back(filterId);
   fetchPublicParams();
@@ -52,6 +74,7 @@ Producer::Producer(const security::v2::Certificate& identityCert, Face& face,
 
 Producer::~Producer()
 {
+  *m_isAlive = false;
   for (auto prefixId : m_interestFilterIds) {
     prefixId.cancel();
   }
@@ -62,11 +85,9 @@ Producer::onAttributePubParams(const Interest& request, const Data& pubParamData
 {
   NDN_LOG_INFO("Get public parameters");
   Name attrAuthorityKey = pubParamData.getSignature().getKeyLocator().getName();
-  for (auto anchor : m_trustConfig.m_trustAnchors) {
-    if (anchor.getKeyName() == attrAuthorityKey) {
-      BOOST_ASSERT(security::verifySignature(pubParamData, anchor));
-      break;
-    }
+  auto anchor = m_trustConfig.findByKeyName(attrAuthorityKey);
+  if (anchor != nullptr) {
+    BOOST_ASSERT(security::verifySignature(pubParamData, *anchor));
   }
   auto block = pubParamData.getContent();
   m_pubParamsCache.fromBuffer(Buffer(block.value(), block.value_size()));
@@ -76,6 +97,22 @@ void
 Producer::produce(const Name& dataPrefix, const std::string& accessPolicy,
                   const uint8_t* content, size_t contentLen,
                   const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback)
+{
+  shared_ptr<const algo::CompiledPolicy> policy;
+  try {
+    policy = compilePolicy(accessPolicy);
+  }
+  catch (const algo::CompiledPolicy::Error& e) {
+    errorCallback(std::string("invalid policy: ") + e.what());
+    return;
+  }
+  produce(dataPrefix, policy, content, contentLen, onDataProduceCb, errorCallback);
+}
+
+void
+Producer::produce(const Name& dataPrefix, const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                  const uint8_t* content, size_t contentLen,
+                  const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback)
 {
   // do encryption
   if (m_pubParamsCache.m_pub == nullptr) {
@@ -83,42 +120,28 @@ Producer::produce(const Name& dataPrefix, const std::string& accessPolicy,
 
     NDN_LOG_INFO("public parameters doesn't exist" );
   }
-  else {
-    NDN_LOG_INFO("encrypt data:"<<dataPrefix );
-    auto cipherText = algo::ABESupport::encrypt(m_pubParamsCache, accessPolicy,
-                                                Buffer(content, contentLen));
-
-    Name ckName = security::v2::extractIdentityFromCertName(m_cert.getName());
-    ckName.append("CK").append(std::to_string(random::generateSecureWord32()));
+  else if (m_useKeyHierarchy) {
+    NDN_LOG_INFO("encrypt data:" << dataPrefix << " under KEK");
+    auto kek = getKek(accessPolicy);
+    kek->nPackets++;
 
     Name dataName = m_cert.getIdentity();
     dataName.append(dataPrefix);
     Data data(dataName);
-    auto dataBlock = makeEmptyBlock(tlv::Content);
-    dataBlock.push_back(cipherText.makeDataContent());
-    dataBlock.push_back(ckName.wireEncode());
-    dataBlock.encode();
-    data.setContent(dataBlock);
+    data.setContent(encryptDataContentWithKek(content, contentLen, kek->key.data(), kek->key.size(),
+                                              kek->name));
     m_keyChain.sign(data, signingByCertificate(m_cert));
-
-    std::cout << data;
-    std::cout << "Content Data length: " << data.wireEncode().size() << std::endl;
-    std::cout << "Content Name length: " << data.getName().wireEncode().size() << std::endl;
-    std::cout << "=================================\n";
-
-    Name ckDataName = ckName;
-    ckDataName.append("ENC-BY").append(accessPolicy);
-    Data ckData(ckDataName);
-    ckData.setContent(cipherText.makeCKContent());
-    m_keyChain.sign(ckData, signingByCertificate(m_cert));
-
-    std::cout << ckData;
-    std::cout << "CK Data length: " << ckData.wireEncode().size() << std::endl;
-    std::cout << "CK Name length: " << ckData.getName().wireEncode().size() << std::endl;
-    std::cout << "=================================\n";
+    publish(data, kek->name);
 
     onDataProduceCb(data);
   }
+  else {
+    NDN_LOG_INFO("encrypt data:"<<dataPrefix );
+    // the content is encrypted straight into the Data content block
+    auto cipherText = algo::ABESupport::encryptDeferred(m_pubParamsCache, *accessPolicy,
+                                                        content, contentLen);
+    onDataProduceCb(publishWithCk(dataPrefix, *accessPolicy, cipherText));
+  }
 }
 
 void
@@ -136,7 +159,398 @@ Producer::produce(const Name& dataPrefix, const uint8_t* content, size_t content
 
 }
 
+void
+Producer::produceChunked(const Name& dataPrefix, const std::string& accessPolicy,
+                         const uint8_t* content, size_t contentLen,
+                         const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback,
+                         size_t chunkSize)
+{
+  shared_ptr<const algo::CompiledPolicy> policy;
+  try {
+    policy = compilePolicy(accessPolicy);
+  }
+  catch (const algo::CompiledPolicy::Error& e) {
+    errorCallback(std::string("invalid policy: ") + e.what());
+    return;
+  }
+  produceChunked(dataPrefix, policy, content, contentLen, onDataProduceCb, errorCallback,
+                 chunkSize);
+}
+
+void
+Producer::produceChunked(const Name& dataPrefix,
+                         const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                         const uint8_t* content, size_t contentLen,
+                         const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback,
+                         size_t chunkSize)
+{
+  if (m_pubParamsCache.m_pub == nullptr) {
+    errorCallback("public key missing");
+    NDN_LOG_INFO("public parameters doesn't exist");
+    return;
+  }
+
+  NDN_LOG_INFO("encrypt data:" << dataPrefix << " in chunks of " << chunkSize << " bytes");
+  algo::CipherText cipherText;
+  try {
+    cipherText = algo::ABESupport::encryptChunked(m_pubParamsCache, *accessPolicy,
+                                                  content, contentLen, chunkSize);
+  }
+  catch (const algo::ABESupport::Error& e) {
+    errorCallback(e.what());
+    return;
+  }
+  onDataProduceCb(publishWithCk(dataPrefix, *accessPolicy, cipherText));
+}
+
+void
+Producer::produceSegmented(const Name& dataPrefix, const std::string& accessPolicy,
+                           const uint8_t* content, size_t contentLen,
+                           const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                           size_t segmentSize)
+{
+  shared_ptr<const algo::CompiledPolicy> policy;
+  try {
+    policy = compilePolicy(accessPolicy);
+  }
+  catch (const algo::CompiledPolicy::Error& e) {
+    errorCallback(std::string("invalid policy: ") + e.what());
+    return;
+  }
+  produceSegmented(dataPrefix, policy, content, contentLen, onSegmentCb, errorCallback,
+                   segmentSize);
+}
+
+void
+Producer::produceSegmented(const Name& dataPrefix,
+                           const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                           const uint8_t* content, size_t contentLen,
+                           const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                           size_t segmentSize)
+{
+  auto contentKey = makeContentKey(accessPolicy, segmentSize, errorCallback);
+  if (contentKey == nullptr) {
+    return;
+  }
+  Name versionedName = m_cert.getIdentity();
+  versionedName.append(dataPrefix).appendVersion();
+
+  // an empty object is still one (empty) segment
+  uint64_t nSegments = std::max<uint64_t>((contentLen + segmentSize - 1) / segmentSize, 1);
+  auto finalBlockId = name::Component::fromSegment(nSegments - 1);
+  NDN_LOG_INFO("encrypt " << versionedName << " into " << nSegments << " segments");
+
+  for (uint64_t segment = 0; segment < nSegments; ++segment) {
+    size_t offset = segment * segmentSize;
+    size_t payloadLen = std::min(segmentSize, contentLen - offset);
+    auto data = makeSegment(versionedName, *contentKey, segment,
+                            content + offset, payloadLen, &finalBlockId);
+    publish(data, contentKey->name);
+    onSegmentCb(data);
+  }
+  retireKek(contentKey);
+}
+
+void
+Producer::produceSegmented(const Name& dataPrefix,
+                           const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                           std::istream& is,
+                           const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                           size_t segmentSize)
+{
+  auto contentKey = makeContentKey(accessPolicy, segmentSize, errorCallback);
+  if (contentKey == nullptr) {
+    return;
+  }
+  Name versionedName = m_cert.getIdentity();
+  versionedName.append(dataPrefix).appendVersion();
+  NDN_LOG_INFO("encrypt " << versionedName << " from a stream");
+
+  auto read = [&is, segmentSize] (Buffer& buffer) {
+    is.read(reinterpret_cast<char*>(buffer.data()), segmentSize);
+    return static_cast<size_t>(is.gcount());
+  };
+
+  // read one segment ahead to learn which segment is the last
+  Buffer current(segmentSize);
+  Buffer next(segmentSize);
+  size_t currentLen = read(current);
+  for (uint64_t segment = 0; !is.bad(); ++segment) {
+    size_t nextLen = currentLen == segmentSize ? read(next) : 0;
+    if (is.bad()) {
+      break;
+    }
+    if (nextLen == 0) {
+      auto finalBlockId = name::Component::fromSegment(segment);
+      auto data = makeSegment(versionedName, *contentKey, segment,
+                              current.data(), currentLen, &finalBlockId);
+      publish(data, contentKey->name);
+      onSegmentCb(data);
+      retireKek(contentKey);
+      return;
+    }
+    auto data = makeSegment(versionedName, *contentKey, segment,
+                            current.data(), currentLen, nullptr);
+    publish(data, contentKey->name);
+    onSegmentCb(data);
+    std::swap(current, next);
+    currentLen = nextLen;
+  }
+
+  // a failed read only shortens what was read, so no segment is sealed as the last one:
+  // consumers see an incomplete object rather than a complete, truncated one
+  retireKek(contentKey);
+  errorCallback("error reading the content stream");
+}
+
+void
+Producer::enableKeyHierarchy(time::milliseconds kekLifetime, uint32_t maxPacketsPerKek)
+{
+  m_kekLifetime = kekLifetime;
+  m_maxPacketsPerKek = maxPacketsPerKek;
+  m_useKeyHierarchy = true;
+  if (m_kekPool == nullptr) {
+    m_kekPool = make_unique<ThreadPool>(1);
+  }
+}
+
+shared_ptr<Producer::Kek>
+Producer::getKek(const shared_ptr<const algo::CompiledPolicy>& accessPolicy)
+{
+  const auto& policyString = accessPolicy->toString();
+  auto& current = m_currentKeks[policyString];
+  if (current != nullptr && !isKekExhausted(*current)) {
+    return current;
+  }
+
+  if (current != nullptr) {
+    retireKek(current);
+  }
+  auto next = m_nextKeks.find(policyString);
+  if (next != m_nextKeks.end()) {
+    current = next->second;
+    m_nextKeks.erase(next);
+  }
+  else {
+    current = makeKek(*accessPolicy);
+  }
+  current->activated = time::steady_clock::now();
+  NDN_LOG_DEBUG("KEK " << current->name << " in use for policy " << policyString);
+
+  // so that the next rotation does not pay for an ABE encryption
+  prepareNextKek(accessPolicy);
+  return current;
+}
+
+void
+Producer::prepareNextKek(const shared_ptr<const algo::CompiledPolicy>& accessPolicy)
+{
+  const auto& policyString = accessPolicy->toString();
+  if (m_nextKeks.count(policyString) > 0 || m_preparingKeks.count(policyString) > 0 ||
+      m_pubParamsCache.m_pub == nullptr) {
+    return;
+  }
+  m_preparingKeks.insert(policyString);
+
+  // the worker gets its own copies, and only the face's thread touches the KEK maps
+  auto key = make_shared<Buffer>(generateKey(KEK_SIZE));
+  auto pubParams = make_shared<algo::PublicParams>(m_pubParamsCache);
+  auto& io = m_face.getIoService();
+  std::weak_ptr<bool> isAlive = m_isAlive;
+  m_kekPool->submit([this, accessPolicy, key, pubParams, &io, isAlive] {
+      shared_ptr<algo::CipherText> cipherText;
+      try {
+        cipherText = make_shared<algo::CipherText>(
+          algo::ABESupport::encrypt(*pubParams, *accessPolicy, *key));
+      }
+      catch (const std::exception& e) {
+        NDN_LOG_ERROR("Cannot prepare the next KEK for " << accessPolicy->toString()
+                      << ": " << e.what());
+      }
+      io.post([this, accessPolicy, key, cipherText, isAlive] {
+          if (isAlive.expired() || !*isAlive.lock()) {
+            return;
+          }
+          const auto& policyString = accessPolicy->toString();
+          m_preparingKeks.erase(policyString);
+          if (cipherText != nullptr && m_nextKeks.count(policyString) == 0) {
+            m_nextKeks[policyString] = addKek(*accessPolicy, std::move(*key), *cipherText);
+          }
+        });
+    });
+}
+
+shared_ptr<Producer::Kek>
+Producer::makeKek(const algo::CompiledPolicy& accessPolicy)
+{
+  return makeKek(accessPolicy, generateKey(KEK_SIZE));
+}
+
+shared_ptr<Producer::Kek>
+Producer::makeKek(const algo::CompiledPolicy& accessPolicy, Buffer key)
+{
+  auto cipherText = algo::ABESupport::encrypt(m_pubParamsCache, accessPolicy, key);
+  return addKek(accessPolicy, std::move(key), cipherText);
+}
+
+void
+Producer::retireKek(const shared_ptr<Kek>& kek)
+{
+  if (!kek->isCkDataSigned) {
+    m_keyChain.sign(kek->ckData, signingByCertificate(m_cert));
+    kek->isCkDataSigned = true;
+  }
+  storeCkData(kek->name, kek->ckData);
+  m_issuedKeks.erase(kek->name);
+  NDN_LOG_DEBUG("KEK " << kek->name << " retired");
+}
+
+Data
+Producer::publishWithCk(const Name& dataPrefix, const algo::CompiledPolicy& accessPolicy,
+                        const algo::CipherText& cipherText)
+{
+  Name ckName = makeCkName();
+
+  Name dataName = m_cert.getIdentity();
+  dataName.append(dataPrefix);
+  Data data(dataName);
+  data.setContent(cipherText.makeDataContent(ckName));
+  m_keyChain.sign(data, signingByCertificate(m_cert));
+  NDN_LOG_DEBUG("content Data " << data.getName() << ", " << data.wireEncode().size() << " bytes");
+
+  Name ckDataName = ckName;
+  ckDataName.append(ENC_BY).append(accessPolicy.toString());
+  Data ckData(ckDataName);
+  ckData.setContent(cipherText.makeCKContent());
+  m_keyChain.sign(ckData, signingByCertificate(m_cert));
+  // the Data first, so that storing it cannot evict its CK Data
+  publish(data, ckName);
+  storeCkData(ckName, ckData);
+  return data;
+}
+
+void
+Producer::storeCkData(const Name& ckName, const Data& ckData)
+{
+  if (!m_store.insert(ckData)) {
+    // nothing encrypted under the key could be decrypted any more
+    NDN_LOG_WARN("CK Data " << ckData.getName() << " does not fit in the store");
+    m_store.erase(ckName);
+  }
+}
+
+shared_ptr<Producer::Kek>
+Producer::addKek(const algo::CompiledPolicy& accessPolicy, Buffer key,
+                 const algo::CipherText& cipherText)
+{
+  auto kek = make_shared<Kek>();
+  kek->key = std::move(key);
+  kek->name = makeCkName();
+
+  Name ckDataName = kek->name;
+  ckDataName.append(ENC_BY).append(accessPolicy.toString());
+  kek->ckData.setName(ckDataName);
+  kek->ckData.setContent(cipherText.wireEncode());
+
+  m_issuedKeks.emplace(kek->name, kek);
+  return kek;
+}
+
+Name
+Producer::makeCkName()
+{
+  // consumers cache content keys by CK name, so a name must never be reused while any
+  // copy of its CK Data may still be around
+  while (true) {
+    Name ckName = m_cert.getIdentity();
+    ckName.append(CK).append(std::to_string(random::generateSecureWord64()));
+    Interest stored(ckName);
+    stored.setCanBePrefix(true);
+    if (m_issuedKeks.count(ckName) == 0 && m_store.find(stored) == nullptr) {
+      return ckName;
+    }
+    NDN_LOG_WARN("CK id collision on " << ckName << ", drawing another");
+  }
+}
+
+Data
+Producer::makeSegment(const Name& versionedName, const Kek& contentKey, uint64_t segment,
+                      const uint8_t* payload, size_t payloadLen, const name::Component* finalBlockId)
+{
+  // the payload is encrypted straight into the content block, as in produce()
+  algo::CipherText cipherText;
+  cipherText.m_suite = algo::CipherSuite::AES_256_GCM;
+  cipherText.m_pendingPlainText = payload;
+  cipherText.m_pendingKey = contentKey.key;
+  cipherText.m_plainTextSize = payloadLen;
+  bool isLast = finalBlockId != nullptr && finalBlockId->toSegment() == segment;
+  cipherText.m_pendingAad = algo::ABESupport::makeSegmentAad(segment, isLast);
+
+  Data data(Name(versionedName).appendSegment(segment));
+  data.setContent(cipherText.makeDataContent(contentKey.name));
+  if (finalBlockId != nullptr) {
+    data.setFinalBlock(*finalBlockId);
+  }
+  m_keyChain.sign(data, signingByCertificate(m_cert));
+  return data;
+}
+
+shared_ptr<Producer::Kek>
+Producer::makeContentKey(const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                         size_t segmentSize, const ErrorCallback& errorCallback)
+{
+  if (m_pubParamsCache.m_pub == nullptr) {
+    errorCallback("public key missing");
+    NDN_LOG_INFO("public parameters doesn't exist");
+    return nullptr;
+  }
+  if (segmentSize == 0) {
+    errorCallback("segment size must be positive");
+    return nullptr;
+  }
+
+  return makeKek(*accessPolicy, generateKey(CONTENT_KEY_SIZE));
+}
+
+shared_ptr<const algo::CompiledPolicy>
+Producer::compilePolicy(const std::string& accessPolicy)
+{
+  auto cached = m_adHocPolicies.find(accessPolicy);
+  if (cached != nullptr) {
+    return *cached;
+  }
+  auto policy = make_shared<const algo::CompiledPolicy>(accessPolicy);
+  m_adHocPolicies.insert(accessPolicy, policy);
+  return policy;
+}
+
+bool
+Producer::isKekExhausted(const Kek& kek) const
+{
+  if (m_maxPacketsPerKek > 0 && kek.nPackets >= m_maxPacketsPerKek) {
+    return true;
+  }
+  return time::steady_clock::now() - kek.activated >= m_kekLifetime;
+}
+
 //private:
+void
+Producer::onInterest(const Interest& interest)
+{
+  // naming: /<producer>/SET_POLICY/..., /<producer>/CK/... or /<producer>/<data prefix>/...
+  const Name& name = interest.getName();
+  size_t nIdentity = m_cert.getIdentity().size();
+  if (name.size() > nIdentity && name.at(nIdentity) == CK) {
+    onCkInterest(interest);
+  }
+  else if (SET_POLICY.isPrefixOf(name.getSubName(nIdentity))) {
+    onPolicyInterest(interest);
+  }
+  else {
+    onDataInterest(interest);
+  }
+}
+
 void
 Producer::onPolicyInterest(const Interest& interest)
 {
@@ -147,13 +561,23 @@ Producer::onPolicyInterest(const Interest& interest)
   // Name policy = interest.getName().getSubName(3,1);
   // _LOG_DEBUG(dataPrefix<<", "<<policy);
 
-  std::pair<std::map<Name,std::string>::iterator,bool> ret;
-  ret = m_policyCache.insert(std::pair<Name, std::string>(Name(dataPrefix),
-                                                          encoding::readString(interest.getName().at(3))));
-
+  std::string policyString = encoding::readString(interest.getName().at(3));
   Data reply;
   reply.setName(interest.getName());
-  if (ret.second==false) {
+
+  // parse and validate once here instead of on every produce call
+  shared_ptr<const algo::CompiledPolicy> policy;
+  try {
+    policy = compilePolicy(policyString);
+  }
+  catch (const algo::CompiledPolicy::Error& e) {
+    NDN_LOG_INFO("invalid policy " << policyString << ": " << e.what());
+  }
+
+  if (policy == nullptr) {
+    reply.setContent(makeStringBlock(tlv::Content, "invalid"));
+  }
+  else if (!m_policyCache.emplace(dataPrefix, policy).second) {
     NDN_LOG_DEBUG("dataPrefix already exist");
 
     NDN_LOG_INFO("insert data prefix "<<dataPrefix<<" policy failed");
@@ -161,7 +585,7 @@ Producer::onPolicyInterest(const Interest& interest)
   }
   else {
     NDN_LOG_DEBUG("insert success");
-    NDN_LOG_INFO("insert data prefix "<<dataPrefix<<" with policy "<<encoding::readString(interest.getName().at(3)) );
+    NDN_LOG_INFO("insert data prefix "<<dataPrefix<<" with policy "<<policyString);
     reply.setContent(makeStringBlock(tlv::Content, "success"));
   }
   NDN_LOG_DEBUG("before sign");
@@ -170,6 +594,54 @@ Producer::onPolicyInterest(const Interest& interest)
   m_face.put(reply);
 }
 
+void
+Producer::onCkInterest(const Interest& interest)
+{
+  // naming: /<producer>/CK/<id>[/ENC-BY/<policy>]
+  NDN_LOG_DEBUG("on CK Interest:" << interest.getName());
+  auto stored = m_store.find(interest);
+  if (stored != nullptr) {
+    m_face.put(*stored);
+    return;
+  }
+
+  // a KEK or content key in use is not in the store until it is retired
+  Name ckName = interest.getName().getPrefix(m_cert.getIdentity().size() + 2);
+  auto kek = m_issuedKeks.find(ckName);
+  if (kek == m_issuedKeks.end()) {
+    NDN_LOG_INFO("unknown CK " << ckName);
+    return;
+  }
+  if (!kek->second->isCkDataSigned) {
+    m_keyChain.sign(kek->second->ckData, signingByCertificate(m_cert));
+    kek->second->isCkDataSigned = true;
+  }
+  const Data& ckData = kek->second->ckData;
+  NDN_LOG_DEBUG("CK Data " << ckData.getName() << ", " << ckData.wireEncode().size() << " bytes");
+  m_face.put(ckData);
+}
+
+void
+Producer::onDataInterest(const Interest& interest)
+{
+  auto stored = m_store.find(interest);
+  if (stored == nullptr) {
+    // not produced yet, or evicted: left to the application
+    NDN_LOG_DEBUG("no stored Data for " << interest.getName());
+    return;
+  }
+  NDN_LOG_DEBUG("answer " << interest.getName() << " from the store");
+  m_face.put(*stored);
+}
+
+void
+Producer::publish(const Data& data, const Name& ckName)
+{
+  if (!m_store.insert(data, ckName)) {
+    NDN_LOG_INFO("Data " << data.getName() << " is larger than the store");
+  }
+}
+
 void
 Producer::fetchPublicParams()
 {
@@ -177,6 +649,7 @@ Producer::fetchPublicParams()
   Name interestName = m_attrAuthorityPrefix;
   interestName.append(AttributeAuthority::PUBLIC_PARAMS);
   Interest interest(interestName);
+  interest.setCanBePrefix(true);
   interest.setMustBeFresh(true);
 
   NDN_LOG_INFO("Requeset public parameters:"<<interest.getName());
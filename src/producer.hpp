@@ -23,6 +23,12 @@
 
 #include "trust-config.hpp"
 #include "algo/public-params.hpp"
+#include "algo/cipher-text.hpp"
+#include "algo/compiled-policy.hpp"
+#include "algo/abe-support.hpp"
+#include "lru-cache.hpp"
+#include "data-store.hpp"
+#include "thread-pool.hpp"
 
 #include <ndn-cxx/security/verification-helpers.hpp>
 
@@ -48,16 +54,22 @@ public:
    * @param identityCert the certificate for data signing
    * @param face the face for publishing data and sending interests
    * @param repeatAttempts the max retry times when timeout or nack
+   * @param storeCapacity the most bytes of produced Data and CK Data kept to answer
+   *        repeated Interests; a Data is evicted along with its CK Data
    */
   Producer(const security::v2::Certificate& identityCert, Face& face,
            security::v2::KeyChain& keyChain, const Name& attrAuthorityPrefix,
-           uint8_t repeatAttempts = 3);
+           uint8_t repeatAttempts = 3, size_t storeCapacity = DEFAULT_STORE_CAPACITY);
 
   ~Producer();
 
   /**
    * @brief Producing data packet
    *
+   * The Data and its CK Data are kept in the producer's store, from which Interests
+   * under /<producer>/<dataPrefix> and /<producer>/CK are answered until they are
+   * evicted.
+   *
    * @param accessPolicy
    * @param content
    * @param contentLen
@@ -68,14 +80,212 @@ public:
           const uint8_t* content, size_t contentLen,
           const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Producing data packet under a policy that has already been compiled
+   */
+  void
+  produce(const Name& dataName, const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+          const uint8_t* content, size_t contentLen,
+          const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback);
+
   void
   produce(const Name& dataPrefix, const uint8_t* content, size_t contentLen,
           const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback);
 
+  /**
+   * @brief Produce one Data packet whose content can be decrypted in parts
+   *
+   * Like produce, but the content is encrypted with CipherSuite::AES_256_GCM_CHUNKED:
+   * every chunk of @p chunkSize bytes is authenticated on its own, so consumers decrypt
+   * the chunks in parallel, or only those of a byte range (see Consumer::consumeRange).
+   * The key hierarchy is not used.
+   */
+  void
+  produceChunked(const Name& dataPrefix, const std::string& accessPolicy,
+                 const uint8_t* content, size_t contentLen,
+                 const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback,
+                 size_t chunkSize = algo::ABESupport::DEFAULT_CHUNK_SIZE);
+
+  void
+  produceChunked(const Name& dataPrefix, const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                 const uint8_t* content, size_t contentLen,
+                 const SuccessCallback& onDataProduceCb, const ErrorCallback& errorCallback,
+                 size_t chunkSize = algo::ABESupport::DEFAULT_CHUNK_SIZE);
+
+  /**
+   * @brief Produce an object of any size as a series of segments
+   *
+   * The segments are named /<producer>/<dataPrefix>/<version>/<segment> and carry
+   * @p segmentSize bytes of the object each, encrypted with AES-256-GCM under a single
+   * content key.  That key is ABE-encrypted once and published as CK Data, whose name
+   * every segment carries.  Each segment authenticates its segment number and whether it
+   * is the last one (see algo::ABESupport::makeSegmentAad).  @p onSegmentCb is called for
+   * each segment in order.
+   */
+  void
+  produceSegmented(const Name& dataPrefix, const std::string& accessPolicy,
+                   const uint8_t* content, size_t contentLen,
+                   const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                   size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+  void
+  produceSegmented(const Name& dataPrefix, const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                   const uint8_t* content, size_t contentLen,
+                   const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                   size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+  /**
+   * @brief Produce segments from @p is until it is exhausted
+   *
+   * Only one segment is held in memory at a time.  As the length of the stream is not
+   * known up front, only the last segment carries the FinalBlockId.  If reading @p is
+   * fails, no segment is sealed as the last one and @p errorCallback is called.
+   */
+  void
+  produceSegmented(const Name& dataPrefix, const shared_ptr<const algo::CompiledPolicy>& accessPolicy,
+                   std::istream& is,
+                   const SuccessCallback& onSegmentCb, const ErrorCallback& errorCallback,
+                   size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+  /**
+   * @brief Switch to the two-level key hierarchy
+   *
+   * Instead of running a full ABE encryption for every Data packet, the producer
+   * ABE-encrypts one key-encryption key (KEK) per policy and wraps a fresh AES content
+   * key for each packet under it.  The KEK is published as the CK Data
+   * (/<producer>/CK/<id>/ENC-BY/<policy>), so consumers do one ABE decryption per KEK.
+   *
+   * A policy's KEK is rotated once it is older than @p kekLifetime or has protected
+   * @p maxPacketsPerKek packets (0 for no packet limit).  The successor is ABE-encrypted
+   * on a worker thread as soon as a KEK comes into use, and handed back to the face's
+   * thread when done.
+   */
+  void
+  enableKeyHierarchy(time::milliseconds kekLifetime, uint32_t maxPacketsPerKek);
+
+PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  struct Kek
+  {
+    Name name; // /<producer>/CK/<id>
+    Buffer key;
+    Data ckData; // ABE-encrypted key, named /<name>/ENC-BY/<policy>
+    bool isCkDataSigned = false; // signed on the first Interest for it
+    time::steady_clock::time_point activated;
+    uint32_t nPackets = 0;
+  };
+
+  shared_ptr<Kek>
+  getKek(const shared_ptr<const algo::CompiledPolicy>& accessPolicy);
+
+  shared_ptr<Kek>
+  makeKek(const algo::CompiledPolicy& accessPolicy);
+
+  /**
+   * @brief ABE-encrypt the successor of the current KEK of @p accessPolicy on m_kekPool,
+   *        unless it is ready or under way
+   */
+  void
+  prepareNextKek(const shared_ptr<const algo::CompiledPolicy>& accessPolicy);
+
+  /**
+   * @brief Draw a fresh /<producer>/CK/<id> name, with a 64-bit random id that no CK
+   *        issued or stored uses
+   */
+  Name
+  makeCkName();
+
+  /**
+   * @brief ABE-encrypt @p key under @p accessPolicy and publish it as CK Data
+   */
+  shared_ptr<Kek>
+  makeKek(const algo::CompiledPolicy& accessPolicy, Buffer key);
+
+  /**
+   * @brief Move the CK Data of a KEK or content key that encrypts nothing more into the
+   *        store, and forget the key
+   *
+   * The CK Data is signed if nobody asked for it yet.  From then on it is served, and
+   * evicted, like the packets encrypted under it.
+   */
+  void
+  retireKek(const shared_ptr<Kek>& kek);
+
+  /**
+   * @brief Sign and store the Data of @p cipherText under a fresh CK name, and its CK Data
+   * @return the Data
+   */
+  Data
+  publishWithCk(const Name& dataPrefix, const algo::CompiledPolicy& accessPolicy,
+                const algo::CipherText& cipherText);
+
+  /**
+   * @brief Keep signed @p ckData in the store, or drop the Data encrypted under
+   *        @p ckName if it does not fit
+   */
+  void
+  storeCkData(const Name& ckName, const Data& ckData);
+
+  /**
+   * @brief Publish @p key, already ABE-encrypted into @p cipherText, as CK Data
+   */
+  shared_ptr<Kek>
+  addKek(const algo::CompiledPolicy& accessPolicy, Buffer key, const algo::CipherText& cipherText);
+
+  /**
+   * @brief Encrypt one segment of an object with @p contentKey, see produceSegmented
+   * @param finalBlockId the last segment of the object, if known; the segment is sealed
+   *                     as the last one if it is @p finalBlockId
+   */
+  Data
+  makeSegment(const Name& versionedName, const Kek& contentKey, uint64_t segment,
+              const uint8_t* payload, size_t payloadLen, const name::Component* finalBlockId);
+
+  /**
+   * @brief Get the compiled form of a policy string passed to produce()
+   * @throw algo::CompiledPolicy::Error the policy is malformed
+   */
+  shared_ptr<const algo::CompiledPolicy>
+  compilePolicy(const std::string& accessPolicy);
+
+  bool
+  isKekExhausted(const Kek& kek) const;
+
+  /**
+   * @brief Answer a CK Interest from the store, or for a key still in use, signing its
+   *        CK Data if this is its first Interest
+   */
+  void
+  onCkInterest(const Interest& interest);
+
+  void
+  onDataInterest(const Interest& interest);
+
+  /**
+   * @brief Keep @p data in the store, from which onDataInterest answers
+   * @param ckName the CK that @p data is encrypted under, if any; @p data leaves the
+   *               store with its CK Data
+   */
+  void
+  publish(const Data& data, const Name& ckName = Name());
+
 private:
+  /**
+   * @brief Create the content key of a segmented object
+   * @return nullptr, after calling @p errorCallback, if the object cannot be encrypted
+   */
+  shared_ptr<Kek>
+  makeContentKey(const shared_ptr<const algo::CompiledPolicy>& accessPolicy, size_t segmentSize,
+                 const ErrorCallback& errorCallback);
+
   void
   onAttributePubParams(const Interest& request, const Data& pubParamData);
 
+  /**
+   * @brief Dispatch an Interest under the producer's identity to the handler of its kind
+   */
+  void
+  onInterest(const Interest& interest);
+
   void
   onPolicyInterest(const Interest& interest);
 
@@ -84,6 +294,16 @@ private:
 
 public:
   const static Name SET_POLICY;
+  const static name::Component CK;
+  const static name::Component ENC_BY;
+
+  /**
+   * Default payload of a segment, which keeps the signed segment under the NDN packet
+   * size limit.
+   */
+  const static size_t DEFAULT_SEGMENT_SIZE;
+
+  const static size_t DEFAULT_STORE_CAPACITY;
 
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   security::v2::Certificate m_cert;
@@ -92,10 +312,25 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   Name m_attrAuthorityPrefix;
   uint8_t m_repeatAttempts;
 
-  std::map<Name/* data prefix */, std::string/* policy */> m_policyCache;
+  std::map<Name/* data prefix */, shared_ptr<const algo::CompiledPolicy>> m_policyCache;
+  LruCache<std::string/* policy */, shared_ptr<const algo::CompiledPolicy>> m_adHocPolicies;
   std::list<InterestFilterHandle> m_interestFilterIds;
   algo::PublicParams m_pubParamsCache;
   TrustConfig m_trustConfig;
+
+  bool m_useKeyHierarchy = false;
+  time::milliseconds m_kekLifetime = time::milliseconds::zero();
+  uint32_t m_maxPacketsPerKek = 0;
+  std::map<std::string/* policy */, shared_ptr<Kek>> m_currentKeks;
+  std::map<std::string/* policy */, shared_ptr<Kek>> m_nextKeks;
+  std::set<std::string/* policy */> m_preparingKeks; // successors being encrypted on m_kekPool
+  // KEKs and content keys still in use; see retireKek
+  std::map<Name/* KEK name */, shared_ptr<Kek>> m_issuedKeks;
+  DataStore m_store;
+  // reset on destruction, so that successors encrypted by running workers are dropped
+  shared_ptr<bool> m_isAlive = make_shared<bool>(true);
+  // started by enableKeyHierarchy, so that producers without KEKs run no thread
+  unique_ptr<ThreadPool> m_kekPool;
 };
 
 } // namespace ndnabac
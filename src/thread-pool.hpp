@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#ifndef NDNABAC_THREAD_POOL_HPP
+#define NDNABAC_THREAD_POOL_HPP
+
+#include "common.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+namespace ndnabac {
+
+/**
+ * @brief A fixed set of worker threads running submitted tasks in FIFO order
+ *
+ * Destroying the pool finishes the tasks already submitted, then joins the workers.
+ */
+class ThreadPool : noncopyable
+{
+public:
+  /**
+   * @param nThreads number of workers; 0 means one per hardware thread
+   */
+  explicit
+  ThreadPool(size_t nThreads = 0);
+
+  ~ThreadPool();
+
+  size_t
+  size() const
+  {
+    return m_workers.size();
+  }
+
+  /**
+   * @brief Run @p task on a worker
+   * @return the future result of @p task; exceptions thrown by it are rethrown by get()
+   */
+  template<typename Task>
+  std::future<typename std::result_of<Task()>::type>
+  submit(Task task)
+  {
+    using Result = typename std::result_of<Task()>::type;
+    auto packaged = make_shared<std::packaged_task<Result()>>(std::move(task));
+    auto future = packaged->get_future();
+    enqueue([packaged] { (*packaged)(); });
+    return future;
+  }
+
+private:
+  void
+  enqueue(function<void()> task);
+
+  void
+  run();
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<function<void()>> m_queue;
+  bool m_isStopping = false;
+  std::vector<std::thread> m_workers;
+};
+
+} // namespace ndnabac
+} // namespace ndn
+
+#endif // NDNABAC_THREAD_POOL_HPP
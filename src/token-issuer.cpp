@@ -64,7 +64,7 @@ TokenIssuer::insertAttributes(std::pair<Name, std::list<std::string>> nameWithAt
 void
 TokenIssuer::addCert(const security::v2::Certificate& cert)
 {
-  m_trustConfig.m_trustAnchors.push_back(cert);
+  m_trustConfig.addCertificate(cert);
 }
 
 void
@@ -77,24 +77,26 @@ TokenIssuer::onTokenRequest(const Interest& request)
 
   // verify request and generate token
   JsonSection root;
-  for (auto anchor : m_trustConfig.m_trustAnchors) {
-    if (anchor.getIdentity() == identityName) {
-      if (!security::verifySignature(request, anchor)) {
-        NDN_LOG_TRACE("Interest is with bad signature");
-        return;
-      }
-
-      std::stringstream ss;
-      namespace t = ndn::security::transform;
-      t::bufferSource(anchor.getPublicKey().data(), anchor.getPublicKey().size())
-        >> t::base64Encode() >> t::streamSink(ss);
-      std::string keyBitsStr = ss.str();
-
-      NDN_LOG_TRACE("Token identity field: " << keyBitsStr);
-
-      root.put(TOKEN_USER, keyBitsStr);
-      break;
+  auto anchor = m_trustConfig.findBySigner(request);
+  if (anchor != nullptr && anchor->getIdentity() != identityName) {
+    NDN_LOG_TRACE("Token request for " << identityName << " signed by " << anchor->getKeyName());
+    return;
+  }
+  if (anchor != nullptr) {
+    if (!security::verifySignature(request, *anchor)) {
+      NDN_LOG_TRACE("Interest is with bad signature");
+      return;
     }
+
+    std::stringstream ss;
+    namespace t = ndn::security::transform;
+    t::bufferSource(anchor->getPublicKey().data(), anchor->getPublicKey().size())
+      >> t::base64Encode() >> t::streamSink(ss);
+    std::string keyBitsStr = ss.str();
+
+    NDN_LOG_TRACE("Token identity field: " << keyBitsStr);
+
+    root.put(TOKEN_USER, keyBitsStr);
   }
 
 //  {
@@ -19,6 +19,7 @@
  */
 
 #include "trust-config.hpp"
+#include <ndn-cxx/security/command-interest-signer.hpp>
 #include <ndn-cxx/util/io.hpp>
 
 namespace ndn {
@@ -42,16 +43,83 @@ TrustConfig::load(const std::string& fileName)
   parse();
 }
 
+void
+TrustConfig::addCertificate(const security::v2::Certificate& cert)
+{
+  const Name& keyName = cert.getKeyName();
+  auto it = m_anchors.find(keyName);
+  if (it != m_anchors.end()) {
+    it->second = cert;
+    return;
+  }
+  m_anchors.emplace(keyName, cert);
+  m_keysByIdentity.emplace(cert.getIdentity(), keyName);
+}
+
+bool
+TrustConfig::removeCertificate(const Name& keyName)
+{
+  auto it = m_anchors.find(keyName);
+  if (it == m_anchors.end()) {
+    return false;
+  }
+  auto keys = m_keysByIdentity.equal_range(it->second.getIdentity());
+  for (auto key = keys.first; key != keys.second; ++key) {
+    if (key->second == keyName) {
+      m_keysByIdentity.erase(key);
+      break;
+    }
+  }
+  m_anchors.erase(it);
+  return true;
+}
+
+const security::v2::Certificate*
+TrustConfig::findByIdentity(const Name& identity) const
+{
+  auto key = m_keysByIdentity.find(identity);
+  if (key == m_keysByIdentity.end()) {
+    return nullptr;
+  }
+  return findByKeyName(key->second);
+}
+
+const security::v2::Certificate*
+TrustConfig::findByKeyName(const Name& keyName) const
+{
+  auto it = m_anchors.find(keyName);
+  return it == m_anchors.end() ? nullptr : &it->second;
+}
+
+const security::v2::Certificate*
+TrustConfig::findBySigner(const Interest& interest) const
+{
+  const Name& name = interest.getName();
+  if (name.size() < signed_interest::MIN_SIZE) {
+    return nullptr;
+  }
+  try {
+    SignatureInfo info(name.at(signed_interest::POS_SIG_INFO).blockFromValue());
+    if (!info.hasKeyLocator() || info.getKeyLocator().getType() != KeyLocator::KeyLocator_Name) {
+      return nullptr;
+    }
+    return findByKeyName(info.getKeyLocator().getName());
+  }
+  catch (const tlv::Error&) {
+    return nullptr;
+  }
+}
+
 void
 TrustConfig::parse()
 {
-  m_trustAnchors.clear();
+  m_anchors.clear();
+  m_keysByIdentity.clear();
   auto caList = m_config.get_child("certificate-list");
   auto it = caList.begin();
   for (; it != caList.end(); it++) {
     std::istringstream ss(it->second.get<std::string>("certificate"));
-    auto certItem = *(io::load<security::v2::Certificate>(ss));
-    m_trustAnchors.push_back(certItem);
+    addCertificate(*(io::load<security::v2::Certificate>(ss)));
   }
 }
 
@@ -35,18 +35,60 @@ public:
   };
 
 public:
+  /**
+   * @brief Replace the trust anchors with those listed in @p fileName
+   */
   void
   load(const std::string& fileName);
 
+  /**
+   * @brief Add @p cert, replacing the anchor with the same key name if any
+   */
+  void
+  addCertificate(const security::v2::Certificate& cert);
+
+  /**
+   * @return whether there was an anchor named @p keyName
+   */
+  bool
+  removeCertificate(const Name& keyName);
+
+  /**
+   * @return an anchor of @p identity, or nullptr; valid until that anchor is removed
+   */
+  const security::v2::Certificate*
+  findByIdentity(const Name& identity) const;
+
+  /**
+   * @return the anchor for @p keyName, or nullptr; valid until that anchor is removed
+   */
+  const security::v2::Certificate*
+  findByKeyName(const Name& keyName) const;
+
+  /**
+   * @return the anchor for the KeyLocator name of signed @p interest, or nullptr if there
+   *         is none or @p interest does not carry one; valid until that anchor is removed
+   * @note this does not verify the signature
+   */
+  const security::v2::Certificate*
+  findBySigner(const Interest& interest) const;
+
+  size_t
+  size() const
+  {
+    return m_anchors.size();
+  }
+
 private:
   void
   parse();
 
-public:
-  std::list<security::v2::Certificate> m_trustAnchors;
-
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   JsonSection m_config;
+
+private:
+  std::unordered_map<Name/* key name */, security::v2::Certificate> m_anchors;
+  std::unordered_multimap<Name/* identity */, Name/* key name */> m_keysByIdentity;
 };
 
 } // namespace ndnabac
@@ -0,0 +1,567 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2017, Regents of the University of California.
+ *
+ * This file is part of ChronoShare, a decentralized file sharing application over NDN.
+ *
+ * ChronoShare is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ChronoShare is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ChronoShare, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ChronoShare authors and contributors.
+ */
+
+#include "algo/abe-support.hpp"
+#include "algo/bswabe-codec.hpp"
+#include "algo/pairing.hpp"
+
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestAbeSupport)
+
+BOOST_AUTO_TEST_CASE(SharedPreparedParams)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  auto prepared = pubParams.getPrepared();
+  BOOST_CHECK(prepared != nullptr);
+  BOOST_CHECK(pubParams.getPrepared() == prepared);
+
+  // same parameters fetched separately share the decoded copy
+  algo::PublicParams fetched;
+  fetched.fromBuffer(pubParams.toBuffer());
+  BOOST_CHECK(fetched.getPrepared() == prepared);
+
+  // different parameters do not
+  algo::PublicParams otherParams;
+  algo::MasterKey otherKey;
+  algo::ABESupport::setup(otherParams, otherKey);
+  BOOST_CHECK(otherParams.getPrepared() != prepared);
+}
+
+BOOST_AUTO_TEST_CASE(Ownership)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  // copies own their serialized bytes but still share the decoded parameters
+  algo::PublicParams copy = pubParams;
+  BOOST_CHECK(copy.m_pub != pubParams.m_pub);
+  BOOST_CHECK(copy.toBuffer() == pubParams.toBuffer());
+  BOOST_CHECK(copy.getPrepared() == pubParams.getPrepared());
+
+  Buffer plainText(16);
+  auto cipherText = algo::ABESupport::encrypt(pubParams, "attr1", plainText);
+  algo::CipherText cipherTextCopy = cipherText;
+  BOOST_CHECK(cipherTextCopy.m_cph != cipherText.m_cph);
+  algo::CipherText moved = std::move(cipherText);
+  BOOST_CHECK(cipherText.m_cph == nullptr);
+
+  auto prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+  auto result = algo::ABESupport::decrypt(pubParams, prvKey, moved);
+  BOOST_CHECK(result == plainText);
+
+  // replacing the parameters must not leave stale decoded handles behind
+  auto prepared = pubParams.getPrepared();
+  algo::MasterKey otherMasterKey;
+  algo::ABESupport::setup(copy, otherMasterKey);
+  BOOST_CHECK(copy.getPrepared() != prepared);
+}
+
+BOOST_AUTO_TEST_CASE(DecodedPrivateKey)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  std::vector<std::string> attrList = {"attr1", "attr2", "attr3", "attr4"};
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+
+  algo::DecodedPrivateKey decoded(pubParams, prvKey);
+  BOOST_CHECK(&decoded.getPublicParams() == pubParams.getPrepared().get());
+  BOOST_CHECK_EQUAL(decoded.getComponents().size(), attrList.size());
+  BOOST_REQUIRE(decoded.findComponent("attr3") != nullptr);
+  BOOST_CHECK_EQUAL(decoded.findComponent("attr3")->attr, "attr3");
+  BOOST_CHECK(decoded.findComponent("attr5") == nullptr);
+
+  Buffer plainText(32);
+  auto cipherText = algo::ABESupport::encrypt(pubParams, "attr5 attr6 1of2", plainText);
+  BOOST_CHECK_THROW(algo::ABESupport::decrypt(decoded, cipherText), algo::ABESupport::Error);
+
+  algo::PublicParams missing;
+  BOOST_CHECK_THROW(algo::DecodedPrivateKey(missing, prvKey), algo::DecodedPrivateKey::Error);
+
+  // a component count far beyond the bytes that follow is malformed, not an allocation
+  size_t offset = 0;
+  auto d = pubParams.getPrepared()->pairing.initG2();
+  algo::BswabeCodec::readElement(prvKey.m_prv.get(), offset, d.get());
+  algo::PrivateKey huge;
+  huge.m_prv = algo::makeByteArray(prvKey.m_prv->data, offset);
+  algo::BswabeCodec::appendUint32(huge.m_prv.get(), 0xFFFFFFFF);
+  BOOST_CHECK_THROW(algo::DecodedPrivateKey(pubParams, huge), algo::BswabeCodec::Error);
+}
+
+BOOST_AUTO_TEST_CASE(PreprocessedKey)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey,
+                                                         {"attr1", "attr2", "attr3"});
+
+  algo::DecodedPrivateKey prepared(pubParams, prvKey);
+  algo::DecodedPrivateKey unprepared(pubParams, prvKey, false);
+  // libbswabe's type A pairing is symmetric
+  BOOST_CHECK(prepared.isPreprocessed());
+  BOOST_CHECK(!unprepared.isPreprocessed());
+
+  Buffer plainText(32);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i);
+  }
+  // the Lagrange coefficient of a leaf is 1 under 1of2, and not under 2of2 or 2of3
+  for (const std::string& policy : {"attr1 attr2 2of2", "attr1 attr4 1of2",
+                                    "attr1 attr3 attr4 2of3"}) {
+    BOOST_TEST_MESSAGE(policy);
+    auto cipherText = algo::ABESupport::encrypt(pubParams, policy, plainText);
+    for (const auto* key : {&prepared, &unprepared}) {
+      auto result = algo::ABESupport::decrypt(*key, cipherText);
+      BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                    plainText.begin(), plainText.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(EncryptDecrypt)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  std::vector<std::string> attrList = {"attr1", "attr3", "attr4"};
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+
+  Buffer plainText(100);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i);
+  }
+  auto cipherText = algo::ABESupport::encrypt(pubParams, "attr1 attr2 attr3 2of3 attr4 2of2",
+                                              plainText);
+  auto result = algo::ABESupport::decrypt(pubParams, prvKey, cipherText);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+}
+
+BOOST_AUTO_TEST_CASE(DeferredEncryption)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1", "attr2"});
+
+  Buffer plainText(100);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i);
+  }
+  algo::CompiledPolicy policy("attr1 attr2 2of2");
+  auto pending = algo::ABESupport::encryptDeferred(pubParams, policy,
+                                                   plainText.data(), plainText.size());
+
+  // the plain text is not owned: a pending cipher text can be moved, but not copied
+  BOOST_CHECK_THROW(algo::CipherText{pending}, algo::CipherText::Error);
+  algo::CipherText cipherText = std::move(pending);
+  BOOST_CHECK(pending.m_pendingPlainText == nullptr);
+  BOOST_CHECK(cipherText.m_pendingPlainText == plainText.data());
+
+  Name ckName("/producer/CK/1");
+  Block content = cipherText.makeDataContent(ckName);
+  content.parse();
+  BOOST_REQUIRE_EQUAL(content.elements().size(), 3);
+  BOOST_CHECK_EQUAL(content.elements()[0].type(), TLV_CipherSuite);
+  BOOST_CHECK_EQUAL(content.elements()[1].type(), TLV_EncryptedContent);
+  BOOST_CHECK_EQUAL(content.elements()[1].value_size(),
+                    algo::ABESupport::getAes256GcmEncryptedSize(plainText.size()));
+  BOOST_CHECK_EQUAL(Name(content.elements()[2]), ckName);
+
+  algo::CipherText decoded;
+  decoded.wireDecode(cipherText.wireEncode());
+  auto result = algo::ABESupport::decrypt(pubParams, prvKey, decoded);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+}
+
+BOOST_AUTO_TEST_CASE(SplitContentKey)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+  algo::DecodedPrivateKey decodedKey(pubParams, prvKey);
+
+  Buffer plainText(300);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i * 3);
+  }
+  auto cipherText = algo::ABESupport::encryptDeferred(pubParams, algo::CompiledPolicy("attr1"),
+                                                      plainText.data(), plainText.size());
+
+  // the consumer gets the content and the CK Data as separate packets
+  algo::CipherText fromData;
+  Name ckName = fromData.wireDecodeDataContent(cipherText.makeDataContent(Name("/producer/CK/2")));
+  BOOST_CHECK_EQUAL(ckName, Name("/producer/CK/2"));
+  algo::CipherText fromCk;
+  fromCk.wireDecodeCKContent(cipherText.makeCKContent());
+  BOOST_CHECK_EQUAL(fromCk.m_suite, algo::CipherSuite::AES_256_GCM);
+  BOOST_CHECK_EQUAL(fromCk.m_plainTextSize, plainText.size());
+
+  auto contentKey = algo::ABESupport::decryptContentKey(decodedKey, fromCk);
+  auto result = algo::ABESupport::decryptContent(fromData, contentKey);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  contentKey[0] ^= 0x01;
+  BOOST_CHECK_THROW(algo::ABESupport::decryptContent(fromData, contentKey), algo::ABESupport::Error);
+}
+
+BOOST_AUTO_TEST_CASE(CipherSuites)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+  algo::CompiledPolicy policy("attr1");
+
+  Buffer plainText(300);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i);
+  }
+
+  // AES-128-CBC cipher texts carry no suite and still decode
+  auto cbc = algo::ABESupport::encrypt(pubParams, policy, plainText, algo::CipherSuite::AES_128_CBC);
+  Block cbcWire = cbc.wireEncode();
+  cbcWire.parse();
+  BOOST_CHECK(cbcWire.find(TLV_CipherSuite) == cbcWire.elements_end());
+  algo::CipherText decoded;
+  decoded.wireDecode(cbcWire);
+  BOOST_CHECK_EQUAL(decoded.m_suite, algo::CipherSuite::AES_128_CBC);
+  auto result = algo::ABESupport::decrypt(pubParams, prvKey, decoded);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  auto gcm = algo::ABESupport::encrypt(pubParams, policy, plainText);
+  BOOST_CHECK_EQUAL(gcm.m_suite, algo::CipherSuite::AES_256_GCM);
+  BOOST_CHECK_EQUAL(gcm.m_content.size(),
+                    algo::ABESupport::getAes256GcmEncryptedSize(plainText.size()));
+  decoded.wireDecode(gcm.wireEncode());
+  BOOST_CHECK_EQUAL(decoded.m_suite, algo::CipherSuite::AES_256_GCM);
+  result = algo::ABESupport::decrypt(pubParams, prvKey, decoded);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  // nonces are random
+  auto gcm2 = algo::ABESupport::encrypt(pubParams, policy, plainText);
+  BOOST_CHECK(!std::equal(gcm.m_content.begin(), gcm.m_content.begin() + 12,
+                          gcm2.m_content.begin()));
+
+  decoded.m_content[20] ^= 0x01;
+  BOOST_CHECK_THROW(algo::ABESupport::decrypt(pubParams, prvKey, decoded),
+                    algo::ABESupport::Error);
+  decoded.m_content.resize(10);
+  BOOST_CHECK_THROW(algo::ABESupport::decrypt(pubParams, prvKey, decoded),
+                    algo::ABESupport::Error);
+
+  Block gcmWire = gcm.wireEncode();
+  gcmWire.parse();
+  Block unknown = makeEmptyBlock(tlv::Content);
+  unknown.push_back(makeNonNegativeIntegerBlock(TLV_CipherSuite, 99));
+  for (const auto& element : gcmWire.elements()) {
+    if (element.type() != TLV_CipherSuite) {
+      unknown.push_back(element);
+    }
+  }
+  unknown.encode();
+  BOOST_CHECK_THROW(decoded.wireDecode(unknown), tlv::Error);
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedContent)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+  algo::DecodedPrivateKey decodedKey(pubParams, prvKey);
+
+  Buffer plainText(1050);
+  for (size_t i = 0; i < plainText.size(); i++) {
+    plainText[i] = static_cast<uint8_t>(i * 7);
+  }
+  auto cipherText = algo::ABESupport::encryptChunked(pubParams, algo::CompiledPolicy("attr1"),
+                                                     plainText.data(), plainText.size(), 100);
+  BOOST_CHECK_EQUAL(cipherText.getChunkCount(), 11);
+  BOOST_CHECK_EQUAL(cipherText.m_content.size(),
+                    algo::ABESupport::getChunkedEncryptedSize(plainText.size(), 100));
+
+  algo::CipherText decoded;
+  decoded.wireDecode(cipherText.wireEncode());
+  BOOST_CHECK_EQUAL(decoded.m_suite, algo::CipherSuite::AES_256_GCM_CHUNKED);
+  BOOST_CHECK_EQUAL(decoded.m_chunkSize, 100);
+  auto result = algo::ABESupport::decrypt(decodedKey, decoded);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  // random access: chunks 3 and 4, then the short last chunk
+  auto contentKey = algo::ABESupport::decryptContentKey(decodedKey, decoded);
+  result = algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 3, 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                plainText.begin() + 300, plainText.begin() + 500);
+  result = algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 10, 1);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                plainText.begin() + 1000, plainText.end());
+  BOOST_CHECK_THROW(algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 10, 2),
+                    algo::ABESupport::Error);
+
+  // byte ranges, which decrypt only the chunks that hold them
+  result = algo::ABESupport::decryptContentRange(decoded, contentKey, 250, 300);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                plainText.begin() + 250, plainText.begin() + 550);
+  result = algo::ABESupport::decryptContentRange(decoded, contentKey, 1040, 100);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                plainText.begin() + 1040, plainText.end());
+  BOOST_CHECK_EQUAL(algo::ABESupport::decryptContentRange(decoded, contentKey, 1050, 10).size(), 0);
+  BOOST_CHECK_THROW(algo::ABESupport::decryptContentRange(decoded, contentKey, 1051, 10),
+                    algo::ABESupport::Error);
+  BOOST_CHECK_THROW(algo::ABESupport::decryptContentRange(decoded, contentKey, 1100, 10),
+                    algo::ABESupport::Error);
+
+  // a damaged chunk fails alone
+  decoded.m_content[5 * 116 + 1] ^= 0x01;
+  BOOST_CHECK_THROW(algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 5, 1),
+                    algo::ABESupport::Error);
+  BOOST_CHECK_NO_THROW(algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 0, 5));
+
+  // dropping whole chunks from the end does not go unnoticed
+  decoded = cipherText;
+  decoded.m_content.resize(10 * 116);
+  BOOST_CHECK_THROW(algo::ABESupport::aes_256_gcm_chunked_decrypt(decoded, contentKey, 9, 1),
+                    algo::ABESupport::Error);
+}
+
+BOOST_AUTO_TEST_CASE(EncryptBatch)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  std::vector<std::string> attrList = {"attr1", "attr2"};
+  algo::DecodedPrivateKey prvKey(pubParams,
+                                 algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList));
+
+  std::vector<Buffer> plainTexts;
+  for (size_t i = 0; i < 16; i++) {
+    Buffer plainText(10 + i);
+    std::fill(plainText.begin(), plainText.end(), static_cast<uint8_t>(i));
+    plainTexts.push_back(plainText);
+  }
+  ThreadPool pool(4);
+  auto cipherTexts = algo::ABESupport::encryptBatch(pubParams, "attr1 attr2 1of2",
+                                                    plainTexts, pool);
+  BOOST_REQUIRE_EQUAL(cipherTexts.size(), plainTexts.size());
+  for (size_t i = 0; i < plainTexts.size(); i++) {
+    auto result = algo::ABESupport::decrypt(prvKey, cipherTexts[i]);
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                  plainTexts[i].begin(), plainTexts[i].end());
+  }
+
+  BOOST_CHECK_THROW(algo::ABESupport::encryptBatch(algo::PublicParams(), "attr1",
+                                                   plainTexts, pool),
+                    algo::ABESupport::Error);
+}
+
+BOOST_AUTO_TEST_CASE(FixedBaseTables)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  auto prepared = pubParams.getPrepared();
+  BOOST_CHECK(prepared != nullptr);
+  algo::PublicParams fetched;
+  fetched.fromBuffer(pubParams.toBuffer());
+  BOOST_CHECK(fetched.getPrepared() == prepared);
+
+  auto preparedMsk = masterKey.getPrepared(pubParams);
+  BOOST_REQUIRE(preparedMsk != nullptr);
+  BOOST_CHECK(preparedMsk->getPublicParams() == prepared);
+  BOOST_CHECK(masterKey.getPrepared(pubParams) == preparedMsk);
+
+  // keys and cipher texts keep the libbswabe wire format
+  std::vector<std::string> attrList = {"attr1", "attr2", "attr3"};
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+  algo::BswabePubPtr pub(bswabe_pub_unserialize(pubParams.m_pub.get(), 0));
+  bswabe_prv_t* prv = bswabe_prv_unserialize(pub.get(), prvKey.m_prv.get(), 0);
+  GByteArray* prvWire = bswabe_prv_serialize(prv);
+  BOOST_CHECK_EQUAL_COLLECTIONS(prvWire->data, prvWire->data + prvWire->len,
+                                prvKey.m_prv->data, prvKey.m_prv->data + prvKey.m_prv->len);
+  g_byte_array_free(prvWire, 1);
+  bswabe_prv_free(prv);
+
+  Buffer plainText(32);
+  auto cipherText = algo::ABESupport::encrypt(pubParams, "attr1 attr2 attr3 2of3 attr4 1of2",
+                                              plainText);
+  bswabe_cph_t* cph = bswabe_cph_unserialize(pub.get(), cipherText.m_cph.get(), 0);
+  GByteArray* cphWire = bswabe_cph_serialize(cph);
+  BOOST_CHECK_EQUAL_COLLECTIONS(cphWire->data, cphWire->data + cphWire->len,
+                                cipherText.m_cph->data, cipherText.m_cph->data + cipherText.m_cph->len);
+  g_byte_array_free(cphWire, 1);
+  bswabe_cph_free(cph);
+
+  BOOST_CHECK_THROW(algo::ABESupport::encrypt(pubParams, "attr1 2of2", plainText),
+                    algo::CompiledPolicy::Error);
+}
+
+BOOST_AUTO_TEST_CASE(WidePolicy)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+
+  // enough leaves for the parallel path
+  size_t nLeaves = algo::ABESupport::PARALLEL_ENCRYPT_MIN_LEAVES + 5;
+  std::string policy;
+  for (size_t i = 0; i < nLeaves; i++) {
+    policy += "role" + std::to_string(i) + " ";
+  }
+  policy += "2of" + std::to_string(nLeaves);
+
+  std::vector<std::string> attrList = {"role3", "role" + std::to_string(nLeaves - 1)};
+  for (size_t i = 10; i < 10 + algo::ABESupport::PARALLEL_DECRYPT_MIN_LEAVES; i++) {
+    attrList.push_back("role" + std::to_string(i));
+  }
+  algo::PrivateKey prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+
+  Buffer plainText(64);
+  auto cipherText = algo::ABESupport::encrypt(pubParams, policy, plainText);
+  algo::BswabePubPtr pub(bswabe_pub_unserialize(pubParams.m_pub.get(), 0));
+  bswabe_cph_t* cph = bswabe_cph_unserialize(pub.get(), cipherText.m_cph.get(), 0);
+  GByteArray* cphWire = bswabe_cph_serialize(cph);
+  BOOST_CHECK_EQUAL_COLLECTIONS(cphWire->data, cphWire->data + cphWire->len,
+                                cipherText.m_cph->data, cipherText.m_cph->data + cipherText.m_cph->len);
+  g_byte_array_free(cphWire, 1);
+  bswabe_cph_free(cph);
+
+  auto result = algo::ABESupport::decrypt(pubParams, prvKey, cipherText);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  // a threshold high enough for the leaf pairings to run in parallel
+  std::string strictPolicy = policy.substr(0, policy.rfind(' ') + 1) +
+                             std::to_string(attrList.size()) + "of" + std::to_string(nLeaves);
+  cipherText = algo::ABESupport::encrypt(pubParams, strictPolicy, plainText);
+  result = algo::ABESupport::decrypt(pubParams, prvKey, cipherText);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), plainText.begin(), plainText.end());
+
+  attrList.pop_back();
+  prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, attrList);
+  BOOST_CHECK_THROW(algo::ABESupport::decrypt(pubParams, prvKey, cipherText), algo::ABESupport::Error);
+}
+
+BOOST_AUTO_TEST_CASE(MultiPairing)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  const algo::Pairing& pairing = pubParams.getPrepared()->pairing;
+  BOOST_CHECK(pairing.isSymmetric());
+
+  std::vector<algo::G1> g1;
+  std::vector<algo::G2> g2;
+  algo::GT expected = pairing.initGT();
+  element_set1(expected.get());
+  for (int i = 0; i < 5; i++) {
+    g1.push_back(pairing.randomG1());
+    g2.push_back(pairing.randomG2());
+    algo::GT gt = pairing.pairing(g1.back(), g2.back());
+    element_mul(expected.get(), expected.get(), gt.get());
+  }
+  algo::GT product = pairing.initGT();
+  pairing.multi_pairing(product, g1, g2);
+  BOOST_CHECK(product == expected);
+
+  g2.pop_back();
+  BOOST_CHECK_THROW(pairing.multi_pairing(product, g1, g2), algo::Pairing::Error);
+
+  algo::G1 hashed = pairing.hashToG1("attr1");
+  algo::G1 copy = hashed;
+  BOOST_CHECK(copy == pairing.hashToG1("attr1"));
+  BOOST_CHECK(copy != pairing.hashToG1("attr2"));
+  BOOST_CHECK_EQUAL(copy.toBuffer().size(), hashed.toBuffer().size());
+}
+
+BOOST_AUTO_TEST_CASE(CompiledPolicy)
+{
+  algo::CompiledPolicy policy("attr1 attr2 attr3 2of3 attr4 1of2");
+  BOOST_CHECK_EQUAL(policy.toString(), "attr1 attr2 attr3 2of3 attr4 1of2");
+  BOOST_CHECK_EQUAL(policy.getRoot().k, 1);
+  BOOST_REQUIRE_EQUAL(policy.getRoot().children.size(), 2);
+  BOOST_CHECK_EQUAL(policy.getRoot().children[0].k, 2);
+  BOOST_CHECK(policy.getRoot().children[1].isLeaf());
+  BOOST_CHECK_EQUAL(policy.getRoot().children[1].leafIndex, 3);
+  std::vector<std::string> leaves = {"attr1", "attr2", "attr3", "attr4"};
+  BOOST_CHECK_EQUAL_COLLECTIONS(policy.getLeafAttributes().begin(), policy.getLeafAttributes().end(),
+                                leaves.begin(), leaves.end());
+
+  BOOST_CHECK_THROW(algo::CompiledPolicy("attr1 attr2 0of2"), algo::CompiledPolicy::Error);
+  BOOST_CHECK_THROW(algo::CompiledPolicy("attr1 attr2 3of2"), algo::CompiledPolicy::Error);
+  BOOST_CHECK_THROW(algo::CompiledPolicy("attr1 1of1"), algo::CompiledPolicy::Error);
+  BOOST_CHECK_THROW(algo::CompiledPolicy("attr1 attr2"), algo::CompiledPolicy::Error);
+  BOOST_CHECK_THROW(algo::CompiledPolicy(""), algo::CompiledPolicy::Error);
+
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  auto hashes = policy.getLeafHashes(pubParams.getPrepared());
+  BOOST_CHECK(policy.getLeafHashes(pubParams.getPrepared()) == hashes);
+}
+
+BOOST_AUTO_TEST_CASE(AttributeHashCache)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::ABESupport::setup(pubParams, masterKey);
+  auto pub = pubParams.getPrepared();
+
+  algo::AttributeHashCache cache(2);
+  auto h1 = cache.get(pub, "attr1");
+  BOOST_CHECK_EQUAL(cache.getMissCount(), 1);
+  BOOST_CHECK(cache.get(pub, "attr1") == h1);
+  BOOST_CHECK_EQUAL(cache.getHitCount(), 1);
+
+  algo::HashedAttribute expected(pub, "attr1");
+  BOOST_CHECK_EQUAL(element_cmp(h1->get(), expected.get()), 0);
+
+  cache.get(pub, "attr2");
+  cache.get(pub, "attr3");
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK(cache.get(pub, "attr1") != h1);
+  BOOST_CHECK_EQUAL(cache.getMissCount(), 4);
+
+  // encryption and key generation go through the process-wide instance
+  auto& shared = algo::AttributeHashCache::getInstance();
+  auto nHits = shared.getHitCount();
+  algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1", "attr2"});
+  algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1", "attr2"});
+  BOOST_CHECK_GE(shared.getHitCount(), nHits + 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn
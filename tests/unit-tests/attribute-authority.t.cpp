@@ -19,6 +19,7 @@
  */
 
 #include "attribute-authority.hpp"
+#include "abe-key-file.hpp"
 
 #include "test-common.hpp"
 #include "dummy-forwarder.hpp"
@@ -26,6 +27,8 @@
 #include <ndn-cxx/security/verification-helpers.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 
+#include <thread>
+
 namespace ndn {
 namespace ndnabac {
 namespace tests {
@@ -43,6 +46,18 @@ public:
     cert = key.getDefaultCertificate();
   }
 
+  /**
+   * @brief Advance the clocks until the key generation workers of @p aa are idle
+   */
+  void
+  waitForKeyRequests(const AttributeAuthority& aa)
+  {
+    for (int i = 0; i < 1000 && aa.m_nQueuedKeyRequests + aa.m_nRunningKeyRequests > 0; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      advanceClocks(time::milliseconds(1));
+    }
+  }
+
 public:
   Name attrAuthorityPrefix;
   security::v2::Certificate cert;
@@ -58,20 +73,61 @@ BOOST_AUTO_TEST_CASE(Constructor)
   BOOST_CHECK(aa.m_masterKey.m_msk != nullptr);
 }
 
+BOOST_AUTO_TEST_CASE(KeyFile)
+{
+  // the file is sealed with an RSA key
+  auto rsaCert = addIdentity("/access-controller-rsa", RsaKeyParams()).getDefaultKey().getDefaultCertificate();
+  auto keyFile = (fs::temp_directory_path() / fs::unique_path()).string();
+
+  util::DummyClientFace face(m_io, {true, true});
+  Buffer pubBuffer;
+  {
+    AttributeAuthority aa(rsaCert, face, m_keyChain, keyFile);
+    pubBuffer = aa.m_pubParams.toBuffer();
+  }
+  BOOST_REQUIRE(fs::exists(keyFile));
+
+  // a restarted authority keeps its keys
+  AttributeAuthority restarted(rsaCert, face, m_keyChain, keyFile);
+  auto restartedBuffer = restarted.m_pubParams.toBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(restartedBuffer.begin(), restartedBuffer.end(),
+                                pubBuffer.begin(), pubBuffer.end());
+  BOOST_REQUIRE(restarted.m_masterKey.m_msk != nullptr);
+
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  BOOST_CHECK(AbeKeyFile::load(keyFile, m_keyChain.getTpm(), rsaCert.getName(), pubParams, masterKey));
+  auto mskBuffer = masterKey.toBuffer();
+  auto restartedMsk = restarted.m_masterKey.toBuffer();
+  BOOST_CHECK_EQUAL_COLLECTIONS(mskBuffer.begin(), mskBuffer.end(),
+                                restartedMsk.begin(), restartedMsk.end());
+
+  // a damaged file is not silently replaced by new keys
+  fs::resize_file(keyFile, fs::file_size(keyFile) / 2);
+  BOOST_CHECK_THROW(AttributeAuthority(rsaCert, face, m_keyChain, keyFile), AbeKeyFile::Error);
+  fs::remove(keyFile);
+  BOOST_CHECK(!AbeKeyFile::load(keyFile, m_keyChain.getTpm(), rsaCert.getName(), pubParams, masterKey));
+}
+
 BOOST_AUTO_TEST_CASE(onPublicParams)
 {
   util::DummyClientFace face(m_io, {true, true});
   AttributeAuthority aa(cert, face, m_keyChain);
   Name interestName = attrAuthorityPrefix;
   Interest request(interestName.append(AttributeAuthority::PUBLIC_PARAMS));
+  request.setCanBePrefix(true);
   auto requiredBuffer = aa.m_pubParams.toBuffer();
 
   advanceClocks(time::milliseconds(20), 60);
 
-  int count = 0;
+  // every request gets the same packet, signed once at setup
+  std::vector<Data> responses;
   face.onSendData.connect([&] (const Data& response) {
-      count++;
+      responses.push_back(response);
       BOOST_CHECK(security::verifySignature(response, cert));
+      BOOST_CHECK(request.getName().isPrefixOf(response.getName()));
+      BOOST_CHECK_EQUAL(response.getName().size(), request.getName().size() + 1);
+      BOOST_CHECK(response.getFreshnessPeriod() >= time::hours(1));
 
       auto block = response.getContent();
       Buffer contentBuffer(block.value(), block.value_size());
@@ -83,10 +139,12 @@ BOOST_AUTO_TEST_CASE(onPublicParams)
                                     requiredBuffer.begin(), requiredBuffer.end());
     });
   face.receive(request);
-
+  advanceClocks(time::milliseconds(20), 60);
+  face.receive(request);
   advanceClocks(time::milliseconds(20), 60);
 
-  BOOST_CHECK_EQUAL(count, 1);
+  BOOST_REQUIRE_EQUAL(responses.size(), 2);
+  BOOST_CHECK(responses[0] == responses[1]);
 }
 
 BOOST_AUTO_TEST_CASE(onPrvKey)
@@ -102,7 +160,7 @@ BOOST_AUTO_TEST_CASE(onPrvKey)
 
   util::DummyClientFace face(m_io, {true, true});
   AttributeAuthority aa(cert, face, m_keyChain);
-  aa.m_trustConfig.m_trustAnchors.push_back(consumerCert);
+  aa.m_trustConfig.addCertificate(consumerCert);
   aa.m_tokens.insert(std::pair<Name, std::list<std::string>>(consumerName, attrList));
 
   Name interestName = attrAuthorityPrefix;
@@ -125,9 +183,99 @@ BOOST_AUTO_TEST_CASE(onPrvKey)
   face.receive(interest);
 
   advanceClocks(time::milliseconds(20), 60);
+  waitForKeyRequests(aa);
   BOOST_CHECK_EQUAL(count, 1);
 }
 
+BOOST_AUTO_TEST_CASE(IssuedKeyCache)
+{
+  auto consumerCert = addIdentity("/consumer", RsaKeyParams()).getDefaultKey().getDefaultCertificate();
+
+  util::DummyClientFace face(m_io, {true, true});
+  AttributeAuthority aa(cert, face, m_keyChain);
+  aa.m_trustConfig.addCertificate(consumerCert);
+  aa.m_tokens[consumerCert.getIdentity()] = {"attr1", "attr2"};
+  advanceClocks(time::milliseconds(20), 60);
+
+  std::vector<Data> responses;
+  face.onSendData.connect([&] (const Data& response) { responses.push_back(response); });
+  auto request = [&] {
+    Name interestName = attrAuthorityPrefix;
+    interestName.append("DKEY").append(consumerCert.getIdentity().wireEncode());
+    Interest interest(interestName);
+    m_keyChain.sign(interest, security::signingByCertificate(consumerCert));
+    face.receive(interest);
+    advanceClocks(time::milliseconds(1), 10);
+  };
+
+  request();
+  waitForKeyRequests(aa);
+  BOOST_REQUIRE_EQUAL(responses.size(), 1);
+  BOOST_CHECK_EQUAL(aa.m_issuedKeys.size(), 1);
+
+  // asking again is answered on the spot, with the same wrapped key
+  request();
+  BOOST_CHECK_EQUAL(aa.m_nRunningKeyRequests, 0);
+  BOOST_REQUIRE_EQUAL(responses.size(), 2);
+  BOOST_CHECK_NE(responses[0].getName(), responses[1].getName());
+  BOOST_CHECK(responses[0].getContent() == responses[1].getContent());
+
+  // new attributes, new key
+  aa.m_tokens[consumerCert.getIdentity()] = {"attr1"};
+  request();
+  waitForKeyRequests(aa);
+  BOOST_REQUIRE_EQUAL(responses.size(), 3);
+  BOOST_CHECK(responses[1].getContent() != responses[2].getContent());
+  BOOST_CHECK_EQUAL(aa.m_issuedKeys.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(KeyRequestQueue)
+{
+  auto consumerCertA = addIdentity("/consumerA", RsaKeyParams()).getDefaultKey().getDefaultCertificate();
+  auto consumerCertB = addIdentity("/consumerB", RsaKeyParams()).getDefaultKey().getDefaultCertificate();
+
+  // one worker, at most three requests waiting for it
+  util::DummyClientFace face(m_io, {true, true});
+  AttributeAuthority aa(cert, face, m_keyChain, "", 1, 3);
+  aa.m_trustConfig.addCertificate(consumerCertA);
+  aa.m_trustConfig.addCertificate(consumerCertB);
+  aa.m_tokens[consumerCertA.getIdentity()] = {"attr1"};
+  aa.m_tokens[consumerCertB.getIdentity()] = {"attr1"};
+  advanceClocks(time::milliseconds(20), 60);
+
+  auto makeRequest = [&] (const security::v2::Certificate& consumerCert) {
+    Name interestName = attrAuthorityPrefix;
+    interestName.append("DKEY").append(consumerCert.getIdentity().wireEncode());
+    Interest interest(interestName);
+    m_keyChain.sign(interest, security::signingByCertificate(consumerCert));
+    return interest;
+  };
+  std::vector<Interest> requests = {makeRequest(consumerCertA), makeRequest(consumerCertA),
+                                    makeRequest(consumerCertA), makeRequest(consumerCertB),
+                                    makeRequest(consumerCertB)};
+
+  std::vector<Data> responses;
+  face.onSendData.connect([&] (const Data& response) { responses.push_back(response); });
+  for (const auto& request : requests) {
+    face.receive(request);
+  }
+  advanceClocks(time::milliseconds(1), 10);
+  waitForKeyRequests(aa);
+
+  // the last request finds the queue full, and B's first request does not wait behind all of A's
+  BOOST_REQUIRE_EQUAL(responses.size(), 5);
+  BOOST_CHECK_EQUAL(responses[0].getName(), requests[4].getName());
+  BOOST_CHECK_EQUAL(responses[0].getContentType(), tlv::ContentType_Nack);
+  BOOST_CHECK_EQUAL(responses[1].getName(), requests[0].getName());
+  BOOST_CHECK_EQUAL(responses[2].getName(), requests[1].getName());
+  BOOST_CHECK_EQUAL(responses[3].getName(), requests[3].getName());
+  BOOST_CHECK_EQUAL(responses[4].getName(), requests[2].getName());
+  for (size_t i = 1; i < responses.size(); i++) {
+    BOOST_CHECK_EQUAL(responses[i].getContentType(), tlv::ContentType_Blob);
+    BOOST_CHECK(security::verifySignature(responses[i], cert));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
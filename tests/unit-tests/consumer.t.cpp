@@ -0,0 +1,486 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2017, Regents of the University of California.
+ *
+ * This file is part of ChronoShare, a decentralized file sharing application over NDN.
+ *
+ * ChronoShare is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ChronoShare is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ChronoShare, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ChronoShare authors and contributors.
+ */
+
+#include "consumer.hpp"
+#include "producer.hpp"
+#include "algo/abe-support.hpp"
+
+#include "test-common.hpp"
+
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+NDN_LOG_INIT(Test.Consumer);
+
+/**
+ * @brief A producer and a consumer whose packets are passed by hand, so that tests see,
+ *        drop and reorder each of them
+ *
+ * Both already have the public parameters, and the consumer has the decryption key of
+ * "attr1" from tokenIssuerPrefix, so only content and CK Data are exchanged.
+ */
+class TestConsumerFixture : public IdentityManagementTimeFixture
+{
+public:
+  using EditReplies = std::function<void (std::vector<Data>&)>;
+
+  TestConsumerFixture()
+    : producerFace(m_io, m_keyChain, {true, true})
+    , consumerFace(m_io, m_keyChain, {true, true})
+    , tokenIssuerPrefix("/tokenIssuer")
+  {
+    algo::ABESupport::setup(pubParams, masterKey);
+    prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+
+    producerCert = addIdentity("/producer").getDefaultKey().getDefaultCertificate();
+    consumerCert = addIdentity("/consumer").getDefaultKey().getDefaultCertificate();
+
+    producer = make_unique<Producer>(producerCert, producerFace, m_keyChain, Name("/authority"));
+    producer->m_pubParamsCache = pubParams;
+    makeConsumer(Consumer::DEFAULT_CK_LIFETIME);
+    advanceClocks(time::milliseconds(10), 10);
+    consumerFace.sentInterests.clear();
+    producerFace.sentInterests.clear();
+  }
+
+  void
+  makeConsumer(time::nanoseconds ckLifetime)
+  {
+    consumer = make_unique<Consumer>(consumerCert, consumerFace, m_keyChain, Name("/authority"),
+                                     3, Consumer::DEFAULT_CK_CACHE_CAPACITY, ckLifetime);
+    consumer->m_pubParamsCache = pubParams;
+    consumer->m_keyCache[tokenIssuerPrefix] =
+      std::make_tuple(Data(), make_shared<algo::DecodedPrivateKey>(pubParams, prvKey));
+  }
+
+  /**
+   * @brief Pass the Interests of the consumer to the producer and the replies back,
+   *        through @p edit if given
+   * @return the names of the Interests passed
+   */
+  std::vector<Name>
+  exchange(const EditReplies& edit = nullptr)
+  {
+    std::vector<Interest> interests;
+    interests.swap(consumerFace.sentInterests);
+    std::vector<Name> names;
+    for (const auto& interest : interests) {
+      names.push_back(interest.getName());
+      producerFace.receive(interest);
+    }
+    advanceClocks(time::milliseconds(10), 10);
+
+    std::vector<Data> replies;
+    replies.swap(producerFace.sentData);
+    if (edit) {
+      edit(replies);
+    }
+    for (const auto& data : replies) {
+      consumerFace.receive(data);
+    }
+    advanceClocks(time::milliseconds(10), 10);
+    return names;
+  }
+
+  /**
+   * @brief Exchange packets until the consumer sends no more Interests
+   * @return the names of all the Interests passed
+   */
+  std::vector<Name>
+  exchangeAll(const EditReplies& edit = nullptr)
+  {
+    std::vector<Name> names;
+    for (int i = 0; i < 100 && !consumerFace.sentInterests.empty(); ++i) {
+      auto passed = exchange(edit);
+      names.insert(names.end(), passed.begin(), passed.end());
+    }
+    return names;
+  }
+
+  static size_t
+  countCkInterests(const std::vector<Name>& names)
+  {
+    return std::count_if(names.begin(), names.end(), [] (const Name& name) {
+        return std::find(name.begin(), name.end(), Producer::CK) != name.end();
+      });
+  }
+
+  Data
+  produceChunked(const Name& dataPrefix, const Buffer& content, size_t chunkSize)
+  {
+    Data result;
+    producer->produceChunked(dataPrefix, "attr1", content.data(), content.size(),
+                             [&] (const Data& data) { result = data; },
+                             [] (const std::string& reason) { BOOST_FAIL(reason); },
+                             chunkSize);
+    return result;
+  }
+
+  Data
+  produce(const Name& dataPrefix, const Buffer& content)
+  {
+    Data result;
+    producer->produce(dataPrefix, "attr1", content.data(), content.size(),
+                      [&] (const Data& data) { result = data; },
+                      [] (const std::string& reason) { BOOST_FAIL(reason); });
+    return result;
+  }
+
+  /**
+   * @brief Consume @p dataName, checking that it decrypts to @p content
+   * @return whether it did, once the packets are exchanged
+   */
+  shared_ptr<bool>
+  consume(const Name& dataName, const Buffer& content)
+  {
+    auto isDone = make_shared<bool>(false);
+    consumer->consume(dataName, tokenIssuerPrefix,
+                      [=] (const Buffer& result) {
+                        BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                                      content.begin(), content.end());
+                        *isDone = true;
+                      },
+                      [] (const std::string& reason) { BOOST_FAIL(reason); });
+    return isDone;
+  }
+
+  std::vector<Data>
+  produceSegmented(const Name& dataPrefix, const Buffer& content, size_t segmentSize)
+  {
+    std::vector<Data> segments;
+    producer->produceSegmented(dataPrefix, "attr1", content.data(), content.size(),
+                               [&] (const Data& data) { segments.push_back(data); },
+                               [] (const std::string& reason) { BOOST_FAIL(reason); },
+                               segmentSize);
+    return segments;
+  }
+
+  /**
+   * @brief What consumeSegmented passed on
+   */
+  struct SegmentedResult
+  {
+    Buffer content;
+    size_t nSegments = 0;
+    bool isComplete = false;
+    std::string error;
+  };
+
+  shared_ptr<SegmentedResult>
+  consumeSegmented(const Name& dataName)
+  {
+    util::SegmentFetcher::Options options;
+    options.initCwnd = 16;
+    options.maxTimeout = time::seconds(2);
+
+    auto result = make_shared<SegmentedResult>();
+    consumer->consumeSegmented(dataName, tokenIssuerPrefix,
+                               [=] (const Buffer& segment) {
+                                 result->content.insert(result->content.end(),
+                                                        segment.begin(), segment.end());
+                                 ++result->nSegments;
+                               },
+                               [=] { result->isComplete = true; },
+                               [=] (const std::string& reason) { result->error = reason; },
+                               options);
+    return result;
+  }
+
+  /**
+   * @brief Exchange packets, letting the consumer's timers run in between, until
+   *        @p result is complete or failed
+   */
+  void
+  exchangeUntilDone(const SegmentedResult& result, const EditReplies& edit = nullptr)
+  {
+    for (int i = 0; i < 20 && !result.isComplete && result.error.empty(); ++i) {
+      exchangeAll(edit);
+      advanceClocks(time::milliseconds(500));
+    }
+  }
+
+  void
+  resign(Data& data)
+  {
+    m_keyChain.sign(data, signingByCertificate(producerCert));
+  }
+
+  /**
+   * @brief Forget the decryption key, so that any later ABE decryption has to ask
+   *        tokenIssuerPrefix for a token first
+   */
+  void
+  forgetDecryptionKey()
+  {
+    consumer->m_keyCache.clear();
+  }
+
+  size_t
+  countTokenInterests(const std::vector<Name>& names) const
+  {
+    return std::count_if(names.begin(), names.end(), [this] (const Name& name) {
+        return tokenIssuerPrefix.isPrefixOf(name);
+      });
+  }
+
+  static Buffer
+  makeContent(size_t size)
+  {
+    Buffer content(size);
+    for (size_t i = 0; i < content.size(); i++) {
+      content[i] = static_cast<uint8_t>(i * 7);
+    }
+    return content;
+  }
+
+public:
+  util::DummyClientFace producerFace;
+  util::DummyClientFace consumerFace;
+  Name tokenIssuerPrefix;
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  algo::PrivateKey prvKey;
+  security::v2::Certificate producerCert;
+  security::v2::Certificate consumerCert;
+  unique_ptr<Producer> producer;
+  unique_ptr<Consumer> consumer;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestConsumer, TestConsumerFixture)
+
+BOOST_AUTO_TEST_CASE(ChunkedContent)
+{
+  auto content = makeContent(1050);
+  Data data = produceChunked(Name("/dataset1/chunked"), content, 100);
+  BOOST_CHECK_EQUAL(data.getName(), Name("/producer/dataset1/chunked"));
+
+  Buffer whole;
+  consumer->consume(data.getName(), tokenIssuerPrefix,
+                    [&] (const Buffer& result) { whole = result; },
+                    [] (const std::string& reason) { BOOST_FAIL(reason); });
+  exchangeAll();
+  BOOST_CHECK_EQUAL_COLLECTIONS(whole.begin(), whole.end(), content.begin(), content.end());
+
+  Buffer range;
+  consumer->consumeRange(data.getName(), tokenIssuerPrefix, 250, 300,
+                         [&] (const Buffer& result) { range = result; },
+                         [] (const std::string& reason) { BOOST_FAIL(reason); });
+  auto names = exchangeAll();
+  BOOST_CHECK_EQUAL_COLLECTIONS(range.begin(), range.end(),
+                                content.begin() + 250, content.begin() + 550);
+  // the content key is cached since consume
+  BOOST_CHECK_EQUAL(countCkInterests(names), 0);
+
+  // cut short at the end of the content
+  consumer->consumeRange(data.getName(), tokenIssuerPrefix, 1000, 100,
+                         [&] (const Buffer& result) { range = result; },
+                         [] (const std::string& reason) { BOOST_FAIL(reason); });
+  exchangeAll();
+  BOOST_CHECK_EQUAL_COLLECTIONS(range.begin(), range.end(),
+                                content.begin() + 1000, content.end());
+
+  std::string error;
+  consumer->consumeRange(data.getName(), tokenIssuerPrefix, 1100, 10,
+                         [] (const Buffer&) { BOOST_FAIL("past the end"); },
+                         [&] (const std::string& reason) { error = reason; });
+  exchangeAll();
+  BOOST_CHECK(!error.empty());
+}
+
+BOOST_AUTO_TEST_CASE(RangeOfUnchunkedContent)
+{
+  auto content = makeContent(300);
+  Data data;
+  producer->produce(Name("/dataset1/whole"), "attr1", content.data(), content.size(),
+                    [&] (const Data& produced) { data = produced; },
+                    [] (const std::string& reason) { BOOST_FAIL(reason); });
+
+  std::string error;
+  consumer->consumeRange(data.getName(), tokenIssuerPrefix, 0, 10,
+                         [] (const Buffer&) { BOOST_FAIL("not chunked"); },
+                         [&] (const std::string& reason) { error = reason; });
+  auto names = exchangeAll();
+  BOOST_CHECK_EQUAL(error, "Content is not chunked");
+  BOOST_CHECK_EQUAL(countCkInterests(names), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SharedContentKey)
+{
+  producer->enableKeyHierarchy(time::hours(1), 0);
+  auto content1 = makeContent(300);
+  auto content2 = makeContent(500);
+  Data data1 = produce(Name("/dataset1/data1"), content1);
+  Data data2 = produce(Name("/dataset1/data2"), content2);
+
+  auto isDone = consume(data1.getName(), content1);
+  auto names = exchangeAll();
+  BOOST_CHECK(*isDone);
+  BOOST_CHECK_EQUAL(countCkInterests(names), 1);
+  BOOST_CHECK_EQUAL(consumer->m_ckCache.size(), 1);
+
+  // the second Data names the same KEK: no CK Interest, and no ABE decryption
+  forgetDecryptionKey();
+  isDone = consume(data2.getName(), content2);
+  names = exchangeAll();
+  BOOST_CHECK(*isDone);
+  BOOST_CHECK_EQUAL(countCkInterests(names), 0);
+  BOOST_CHECK_EQUAL(countTokenInterests(names), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ContentKeyLifetime)
+{
+  makeConsumer(time::seconds(10));
+  producer->enableKeyHierarchy(time::hours(1), 0);
+  auto content = makeContent(300);
+  Data data1 = produce(Name("/dataset1/data1"), content);
+  Data data2 = produce(Name("/dataset1/data2"), content);
+  Data data3 = produce(Name("/dataset1/data3"), content);
+
+  auto isDone = consume(data1.getName(), content);
+  BOOST_CHECK_EQUAL(countCkInterests(exchangeAll()), 1);
+  BOOST_CHECK(*isDone);
+
+  advanceClocks(time::seconds(1), 5);
+  isDone = consume(data2.getName(), content);
+  BOOST_CHECK_EQUAL(countCkInterests(exchangeAll()), 0);
+  BOOST_CHECK(*isDone);
+
+  // expired: the CK Data is fetched and decrypted again
+  advanceClocks(time::seconds(1), 6);
+  isDone = consume(data3.getName(), content);
+  BOOST_CHECK_EQUAL(countCkInterests(exchangeAll()), 1);
+  BOOST_CHECK(*isDone);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentContentKeyFetches)
+{
+  producer->enableKeyHierarchy(time::hours(1), 0);
+  auto content1 = makeContent(300);
+  auto content2 = makeContent(500);
+  Data data1 = produce(Name("/dataset1/data1"), content1);
+  Data data2 = produce(Name("/dataset1/data2"), content2);
+
+  // both Data arrive before the CK Data
+  auto isDone1 = consume(data1.getName(), content1);
+  auto isDone2 = consume(data2.getName(), content2);
+  BOOST_CHECK_EQUAL(countCkInterests(exchange()), 0);
+  BOOST_CHECK_EQUAL(consumer->m_pendingCks.size(), 1);
+
+  auto names = exchangeAll();
+  BOOST_CHECK_EQUAL(countCkInterests(names), 1);
+  BOOST_CHECK(*isDone1);
+  BOOST_CHECK(*isDone2);
+  BOOST_CHECK(consumer->m_pendingCks.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SegmentsOutOfOrder)
+{
+  auto content = makeContent(4500);
+  auto segments = produceSegmented(Name("/dataset1/large"), content, 1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 5);
+
+  auto result = consumeSegmented(Name("/producer/dataset1/large"));
+  exchangeUntilDone(*result, [] (std::vector<Data>& replies) {
+      std::reverse(replies.begin(), replies.end());
+    });
+  BOOST_CHECK_EQUAL(result->error, "");
+  BOOST_CHECK(result->isComplete);
+  BOOST_CHECK_EQUAL(result->nSegments, 5);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result->content.begin(), result->content.end(),
+                                content.begin(), content.end());
+}
+
+BOOST_AUTO_TEST_CASE(MissingFinalSegment)
+{
+  auto content = makeContent(4500);
+  auto segments = produceSegmented(Name("/dataset1/large"), content, 1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 5);
+  Name lastName = segments.back().getName();
+
+  auto result = consumeSegmented(Name("/producer/dataset1/large"));
+  exchangeUntilDone(*result, [&] (std::vector<Data>& replies) {
+      replies.erase(std::remove_if(replies.begin(), replies.end(),
+                                   [&] (const Data& data) { return data.getName() == lastName; }),
+                    replies.end());
+    });
+  BOOST_CHECK(!result->isComplete);
+  BOOST_CHECK_EQUAL(result->error.find("Cannot fetch segments"), 0);
+  BOOST_CHECK_EQUAL(result->nSegments, 4);
+}
+
+BOOST_AUTO_TEST_CASE(SegmentsUnderDifferentContentKeys)
+{
+  auto content = makeContent(2500);
+  auto segments = produceSegmented(Name("/dataset1/a"), content, 1000);
+  auto others = produceSegmented(Name("/dataset1/b"), content, 1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 3);
+  BOOST_REQUIRE_EQUAL(others.size(), 3);
+
+  // segment 1 of another object, under this object's name
+  Data forged = segments[1];
+  forged.setContent(others[1].getContent());
+  resign(forged);
+
+  auto result = consumeSegmented(Name("/producer/dataset1/a"));
+  exchangeUntilDone(*result, [&] (std::vector<Data>& replies) {
+      for (auto& data : replies) {
+        if (data.getName() == forged.getName()) {
+          data = forged;
+        }
+      }
+    });
+  BOOST_CHECK(!result->isComplete);
+  BOOST_CHECK_EQUAL(result->error, "Segments are encrypted under different content keys");
+  BOOST_CHECK_LT(result->nSegments, 3);
+}
+
+BOOST_AUTO_TEST_CASE(SegmentFailsDecryption)
+{
+  auto content = makeContent(2500);
+  auto segments = produceSegmented(Name("/dataset1/large"), content, 1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 3);
+
+  // the payload of segment 0, authenticated as segment 0 only
+  Data forged = segments[1];
+  forged.setContent(segments[0].getContent());
+  resign(forged);
+
+  auto result = consumeSegmented(Name("/producer/dataset1/large"));
+  exchangeUntilDone(*result, [&] (std::vector<Data>& replies) {
+      for (auto& data : replies) {
+        if (data.getName() == forged.getName()) {
+          data = forged;
+        }
+      }
+    });
+  BOOST_CHECK(!result->isComplete);
+  BOOST_CHECK_EQUAL(result->error.find("Cannot decrypt segment 1"), 0);
+  BOOST_CHECK_LT(result->nSegments, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn
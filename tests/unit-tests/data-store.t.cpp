@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "data-store.hpp"
+
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+BOOST_FIXTURE_TEST_SUITE(TestDataStore, IdentityManagementFixture)
+
+BOOST_AUTO_TEST_CASE(EvictionAndLookup)
+{
+  auto makeData = [this] (const Name& name) {
+    Data data(name);
+    data.setContent(Buffer(100).data(), 100);
+    m_keyChain.sign(data);
+    return data;
+  };
+  auto a = makeData("/p/a/1");
+  auto b = makeData("/p/b/1");
+  auto c = makeData("/p/c/1");
+
+  DataStore store(a.wireEncode().size() + b.wireEncode().size());
+  BOOST_CHECK(store.insert(a));
+  BOOST_CHECK(store.insert(b));
+  BOOST_CHECK_EQUAL(store.size(), 2);
+
+  // exact names only, unless the Interest can be a prefix
+  BOOST_CHECK(store.find(Interest("/p/a")) == nullptr);
+  Interest prefixInterest("/p/a");
+  prefixInterest.setCanBePrefix(true);
+  BOOST_REQUIRE(store.find(prefixInterest) != nullptr);
+  BOOST_CHECK_EQUAL(store.find(prefixInterest)->getName(), a.getName());
+
+  // "/p/b/1" is now the least recently served packet
+  BOOST_CHECK(store.insert(c));
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  BOOST_CHECK(store.find(Interest("/p/b/1")) == nullptr);
+  BOOST_CHECK(store.find(Interest("/p/a/1")) != nullptr);
+  BOOST_CHECK(store.find(Interest("/p/c/1")) != nullptr);
+  BOOST_CHECK_LE(store.getBytes(), store.getCapacity());
+
+  BOOST_CHECK(store.erase("/p/a/1"));
+  BOOST_CHECK(!store.erase("/p/a/1"));
+  BOOST_CHECK_EQUAL(store.getBytes(), c.wireEncode().size());
+
+  DataStore small(10);
+  BOOST_CHECK(!small.insert(a));
+  BOOST_CHECK_EQUAL(small.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Dependents)
+{
+  auto makeData = [this] (const Name& name) {
+    Data data(name);
+    data.setContent(Buffer(100).data(), 100);
+    m_keyChain.sign(data);
+    return data;
+  };
+  auto ck = makeData("/p/CK/1/ENC-BY/attr1");
+  auto a = makeData("/p/a/1");
+  auto b = makeData("/p/b/1");
+  auto c = makeData("/p/c/1");
+
+  DataStore store(a.wireEncode().size() + b.wireEncode().size() + ck.wireEncode().size());
+  BOOST_CHECK(store.insert(a, "/p/CK/1"));
+  BOOST_CHECK(store.insert(ck));
+  BOOST_CHECK(store.insert(b));
+
+  // serving "/p/a/1" refreshes its CK Data too, so "/p/b/1" goes first
+  BOOST_CHECK(store.find(Interest("/p/a/1")) != nullptr);
+  BOOST_CHECK(store.insert(c));
+  BOOST_CHECK(store.find(Interest("/p/b/1")) == nullptr);
+  BOOST_CHECK(store.find(Interest("/p/a/1")) != nullptr);
+
+  // replacing the CK Data keeps its dependents, evicting it does not
+  BOOST_CHECK(store.insert(ck));
+  BOOST_CHECK(store.find(Interest("/p/a/1")) != nullptr);
+  BOOST_CHECK(store.find(Interest("/p/c/1")) != nullptr);
+  BOOST_CHECK(store.insert(b));
+  BOOST_CHECK(store.find(Interest("/p/CK/1/ENC-BY/attr1")) == nullptr);
+  BOOST_CHECK(store.find(Interest("/p/a/1")) == nullptr);
+  BOOST_CHECK_EQUAL(store.size(), 2);
+
+  // a key that is not stored still takes its dependents along
+  BOOST_CHECK(store.insert(a, "/p/CK/2"));
+  BOOST_CHECK(!store.erase("/p/CK/2"));
+  BOOST_CHECK(store.find(Interest("/p/a/1")) == nullptr);
+  BOOST_CHECK_EQUAL(store.size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn
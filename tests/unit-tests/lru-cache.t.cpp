@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2013-2017, Regents of the University of California.
+ *
+ * This file is part of ChronoShare, a decentralized file sharing application over NDN.
+ *
+ * ChronoShare is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ChronoShare is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ChronoShare, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ChronoShare authors and contributors.
+ */
+
+#include "lru-cache.hpp"
+
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestLruCache)
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+  LruCache<std::string, int> cache(2);
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+  BOOST_REQUIRE(cache.find("a") != nullptr);
+  BOOST_CHECK_EQUAL(*cache.find("a"), 1);
+
+  // "b" is now the least recently used entry
+  cache.insert("c", 3);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK(cache.find("b") == nullptr);
+  BOOST_CHECK(cache.find("a") != nullptr);
+  BOOST_CHECK(cache.find("c") != nullptr);
+
+  cache.insert("a", 4);
+  BOOST_CHECK_EQUAL(*cache.find("a"), 4);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+
+  BOOST_CHECK(cache.erase("a"));
+  BOOST_CHECK(!cache.erase("a"));
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn
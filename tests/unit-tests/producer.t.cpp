@@ -23,6 +23,7 @@
 #include "test-common.hpp"
 #include "dummy-forwarder.hpp"
 #include "algo/abe-support.hpp"
+#include "ndn-crypto/data-enc-dec.hpp"
 
 namespace ndn {
 namespace ndnabac {
@@ -34,6 +35,30 @@ const uint8_t PLAIN_TEXT[1024] = {1};
 
 NDN_LOG_INIT(Test.Producer);
 
+/**
+ * @brief Serves some bytes, then fails as a broken disk would instead of reaching the end
+ */
+class FailingStreamBuf : public std::streambuf
+{
+public:
+  explicit
+  FailingStreamBuf(std::string bytes)
+    : m_bytes(std::move(bytes))
+  {
+    setg(&m_bytes[0], &m_bytes[0], &m_bytes[0] + m_bytes.size());
+  }
+
+protected:
+  int_type
+  underflow() override
+  {
+    throw std::ios_base::failure("read error");
+  }
+
+private:
+  std::string m_bytes;
+};
+
 class TestProducerFixture : public IdentityManagementTimeFixture
 {
 public:
@@ -138,7 +163,7 @@ BOOST_AUTO_TEST_CASE(onPolicyInterest)
   auto it = producer.m_policyCache.find(dataPrefix);
   BOOST_CHECK_EQUAL(producer.m_policyCache.size(), 1);
   BOOST_CHECK(it != producer.m_policyCache.end());
-  BOOST_CHECK_EQUAL(it->second, "policy");
+  BOOST_CHECK_EQUAL(it->second->toString(), "policy");
 
   advanceClocks(time::milliseconds(20), 60);
 
@@ -155,7 +180,7 @@ BOOST_AUTO_TEST_CASE(onPolicyInterest)
   it = producer.m_policyCache.find(dataPrefix);
   BOOST_CHECK_EQUAL(producer.m_policyCache.size(), 1);
   BOOST_CHECK(it != producer.m_policyCache.end());
-  BOOST_CHECK_EQUAL(it->second, "policy");
+  BOOST_CHECK_EQUAL(it->second->toString(), "policy");
 }
 
 BOOST_AUTO_TEST_CASE(encryptContent)
@@ -190,6 +215,243 @@ BOOST_AUTO_TEST_CASE(encryptContent)
                    });
 }
 
+BOOST_AUTO_TEST_CASE(KeyHierarchy)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  Producer producer(cert, c1, m_keyChain, attrAuthorityPrefix);
+  advanceClocks(time::milliseconds(20), 60);
+  algo::ABESupport::setup(pubParams, masterKey);
+  producer.m_pubParamsCache = pubParams;
+  BOOST_CHECK(producer.m_kekPool == nullptr);
+  producer.enableKeyHierarchy(time::hours(1), 2);
+  BOOST_CHECK(producer.m_kekPool != nullptr);
+  BOOST_CHECK_EQUAL(producer.m_interestFilterIds.size(), 1);
+
+  // successors are encrypted on a worker and handed back through the face's io_service
+  auto waitForNextKek = [&] {
+    for (int i = 0; i < 5000 && producer.m_nextKeks.empty(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      advanceClocks(time::milliseconds(1), 1);
+    }
+  };
+
+  std::vector<Name> kekNames;
+  for (int i = 0; i < 3; i++) {
+    producer.produce(Name("/dataset1/example/data1"), "attr1 attr2 1of2", PLAIN_TEXT, sizeof(PLAIN_TEXT),
+                     [&] (const Data& data) {
+                       Block content = data.getContent();
+                       content.parse();
+                       Name kekName(content.get(tlv::Name));
+                       kekNames.push_back(kekName);
+
+                       auto kek = producer.m_issuedKeks.at(kekName);
+                       auto result = decryptDataContentWithKek(content, kek->key.data(), kek->key.size());
+                       BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                                     PLAIN_TEXT, PLAIN_TEXT + sizeof(PLAIN_TEXT));
+
+                       // authenticated with the KEK name: the same content under
+                       // another KEK name does not decrypt
+                       Block moved(tlv::Content);
+                       for (const auto& element : content.elements()) {
+                         moved.push_back(element.type() == tlv::Name ?
+                                         Name(kekName).append("other").wireEncode() : element);
+                       }
+                       moved.encode();
+                       BOOST_CHECK_THROW(decryptDataContentWithKek(moved, kek->key.data(),
+                                                                   kek->key.size()),
+                                         algo::ABESupport::Error);
+                     },
+                     [&] (const std::string& err) {
+                       BOOST_CHECK(false);
+                     });
+    BOOST_CHECK(producer.m_nextKeks.size() + producer.m_preparingKeks.size() == 1);
+    waitForNextKek();
+  }
+
+  BOOST_REQUIRE_EQUAL(kekNames.size(), 3);
+  BOOST_CHECK_EQUAL(kekNames[0], kekNames[1]);
+  BOOST_CHECK_NE(kekNames[1], kekNames[2]);
+  // successor of the current KEK has been prepared in the background
+  BOOST_CHECK_EQUAL(producer.m_nextKeks.size(), 1);
+  BOOST_CHECK(producer.m_preparingKeks.empty());
+  // the rotated-out KEK is only left as signed CK Data in the store
+  BOOST_CHECK_EQUAL(producer.m_issuedKeks.size(), 2);
+  BOOST_CHECK_EQUAL(producer.m_issuedKeks.count(kekNames[0]), 0);
+  Interest ckInterest(kekNames[0]);
+  ckInterest.setCanBePrefix(true);
+  BOOST_CHECK(producer.m_store.find(ckInterest) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Segmented)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  Producer producer(cert, c1, m_keyChain, attrAuthorityPrefix);
+  advanceClocks(time::milliseconds(20), 60);
+  algo::ABESupport::setup(pubParams, masterKey);
+  producer.m_pubParamsCache = pubParams;
+
+  auto prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+
+  Buffer object(2500);
+  for (size_t i = 0; i < object.size(); i++) {
+    object[i] = static_cast<uint8_t>(i);
+  }
+
+  auto checkSegments = [&] (const std::vector<Data>& segments, bool hasFinalBlockIds) {
+    Buffer result;
+    Name ckName;
+    for (size_t i = 0; i < segments.size(); i++) {
+      const auto& segment = segments[i];
+      BOOST_CHECK(segment.getName().get(-1).isSegment());
+      BOOST_CHECK_EQUAL(segment.getName().get(-1).toSegment(), i);
+      BOOST_CHECK(segment.getName().get(-2).isVersion());
+      bool isLast = i + 1 == segments.size();
+      BOOST_CHECK_EQUAL(static_cast<bool>(segment.getFinalBlock()), hasFinalBlockIds || isLast);
+
+      algo::CipherText cipherText;
+      Name segmentCkName = cipherText.wireDecodeDataContent(segment.getContent());
+      if (i == 0) {
+        ckName = segmentCkName;
+      }
+      BOOST_CHECK_EQUAL(segmentCkName, ckName);
+      // the content key is retired once the object is produced, so recover it from the
+      // CK Data in the store
+      Interest ckInterest(ckName);
+      ckInterest.setCanBePrefix(true);
+      auto ckData = producer.m_store.find(ckInterest);
+      BOOST_REQUIRE(ckData != nullptr);
+      algo::CipherText ckCipherText;
+      ckCipherText.wireDecode(ckData->getContent());
+      auto key = algo::ABESupport::decrypt(pubParams, prvKey, ckCipherText);
+      const auto& content = cipherText.m_content;
+      auto payload = algo::ABESupport::aes_256_gcm_decrypt(content.data(), content.size(), key,
+                                                           algo::ABESupport::makeSegmentAad(i, isLast));
+      result.insert(result.end(), payload.begin(), payload.end());
+
+      // served as another segment, or as the end of a truncated object
+      BOOST_CHECK_THROW(algo::ABESupport::aes_256_gcm_decrypt(content.data(), content.size(), key,
+                          algo::ABESupport::makeSegmentAad((i + 1) % segments.size(), isLast)),
+                        algo::ABESupport::Error);
+      BOOST_CHECK_THROW(algo::ABESupport::aes_256_gcm_decrypt(content.data(), content.size(), key,
+                          algo::ABESupport::makeSegmentAad(i, !isLast)),
+                        algo::ABESupport::Error);
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), object.begin(), object.end());
+  };
+
+  std::vector<Data> segments;
+  producer.produceSegmented(Name("/dataset1/large"), "attr1 attr2 1of2",
+                            object.data(), object.size(),
+                            [&] (const Data& segment) { segments.push_back(segment); },
+                            [&] (const std::string& err) { BOOST_CHECK(false); },
+                            1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 3);
+  checkSegments(segments, true);
+  BOOST_CHECK(producer.m_issuedKeks.empty());
+  // the CK Data and the segments are served through the identity's single filter
+  BOOST_CHECK_EQUAL(producer.m_interestFilterIds.size(), 1);
+
+  // a stream that ends on a segment boundary
+  object.resize(2000);
+  std::istringstream is(std::string(object.begin(), object.end()));
+  segments.clear();
+  producer.produceSegmented(Name("/dataset1/stream"), producer.compilePolicy("attr1"), is,
+                            [&] (const Data& segment) { segments.push_back(segment); },
+                            [&] (const std::string& err) { BOOST_CHECK(false); },
+                            1000);
+  BOOST_REQUIRE_EQUAL(segments.size(), 2);
+  checkSegments(segments, false);
+  BOOST_CHECK_EQUAL(producer.m_interestFilterIds.size(), 1);
+
+  producer.produceSegmented(Name("/dataset1/large"), "attr1", object.data(), object.size(),
+                            [&] (const Data&) { BOOST_CHECK(false); },
+                            [&] (const std::string& err) {},
+                            0);
+}
+
+BOOST_AUTO_TEST_CASE(SegmentedStreamError)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  Producer producer(cert, c1, m_keyChain, attrAuthorityPrefix);
+  advanceClocks(time::milliseconds(20), 60);
+  algo::ABESupport::setup(pubParams, masterKey);
+  producer.m_pubParamsCache = pubParams;
+
+  // the read of the third segment fails half-way, and on a segment boundary
+  for (size_t nBytes : {2500, 2000}) {
+    FailingStreamBuf buf(std::string(nBytes, 'x'));
+    std::istream is(&buf);
+    std::vector<Data> segments;
+    std::string error;
+    producer.produceSegmented(Name("/dataset1/broken"), producer.compilePolicy("attr1"), is,
+                              [&] (const Data& segment) { segments.push_back(segment); },
+                              [&] (const std::string& err) { error = err; },
+                              1000);
+    // the second segment is read, but not emitted, as it might not be the last one
+    BOOST_REQUIRE_EQUAL(segments.size(), 1);
+    BOOST_CHECK(!segments[0].getFinalBlock());
+    BOOST_CHECK(!error.empty());
+    BOOST_CHECK(producer.m_issuedKeks.empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Store)
+{
+  algo::PublicParams pubParams;
+  algo::MasterKey masterKey;
+  Producer producer(cert, c1, m_keyChain, attrAuthorityPrefix);
+  advanceClocks(time::milliseconds(20), 60);
+  algo::ABESupport::setup(pubParams, masterKey);
+  producer.m_pubParamsCache = pubParams;
+
+  Data produced;
+  producer.produce(Name("/dataset1/example/data1"), "attr1 attr2 1of2", PLAIN_TEXT, sizeof(PLAIN_TEXT),
+                   [&] (const Data& data) { produced = data; },
+                   [&] (const std::string& err) { BOOST_CHECK(false); });
+  // the Data and its CK Data share the store's byte budget
+  BOOST_CHECK_EQUAL(producer.m_store.size(), 2);
+  algo::CipherText cipherText;
+  Name ckName = cipherText.wireDecodeDataContent(produced.getContent());
+
+  // repeated Interests for the Data and its CK Data are answered without producing again
+  std::vector<Data> received;
+  auto fetch = [&] (const Name& name) {
+    Interest interest(name);
+    interest.setCanBePrefix(true);
+    c2.expressInterest(interest,
+                       [&] (const Interest&, const Data& data) { received.push_back(data); },
+                       [&] (const Interest&, const lp::Nack&) { BOOST_CHECK(false); },
+                       [&] (const Interest&) { BOOST_CHECK(false); });
+    advanceClocks(time::milliseconds(20), 10);
+  };
+  fetch(produced.getName());
+  fetch(produced.getName());
+  fetch(ckName);
+  fetch(ckName);
+  BOOST_CHECK_EQUAL(producer.m_store.size(), 2);
+  BOOST_REQUIRE_EQUAL(received.size(), 4);
+  BOOST_CHECK(received[2] == received[3]);
+  BOOST_CHECK(received[0] == produced);
+  BOOST_CHECK(received[1] == produced);
+  BOOST_CHECK(ckName.isPrefixOf(received[2].getName()));
+
+  algo::CipherText ckCipherText;
+  ckCipherText.wireDecodeCKContent(received[2].getContent());
+  auto prvKey = algo::ABESupport::prvKeyGen(pubParams, masterKey, {"attr1"});
+  auto contentKey = algo::ABESupport::decryptContentKey(algo::DecodedPrivateKey(pubParams, prvKey),
+                                                        ckCipherText);
+  auto result = algo::ABESupport::decryptContent(cipherText, contentKey);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(),
+                                PLAIN_TEXT, PLAIN_TEXT + sizeof(PLAIN_TEXT));
+
+  // the Data is never served without its CK Data
+  BOOST_CHECK(producer.m_store.erase(received[2].getName()));
+  BOOST_CHECK_EQUAL(producer.m_store.size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
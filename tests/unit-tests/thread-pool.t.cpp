@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "thread-pool.hpp"
+
+#include "test-common.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestThreadPool)
+
+BOOST_AUTO_TEST_CASE(Submit)
+{
+  std::atomic<int> nRuns(0);
+  std::vector<std::future<int>> futures;
+  {
+    ThreadPool pool(3);
+    BOOST_CHECK_EQUAL(pool.size(), 3);
+    for (int i = 0; i < 20; i++) {
+      futures.push_back(pool.submit([i, &nRuns] {
+            nRuns++;
+            return i * i;
+          }));
+    }
+    auto failed = pool.submit([]() -> int { BOOST_THROW_EXCEPTION(std::runtime_error("task")); });
+    BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+  }
+
+  // the destructor finishes queued tasks
+  BOOST_CHECK_EQUAL(nRuns, 20);
+  for (int i = 0; i < 20; i++) {
+    BOOST_CHECK_EQUAL(futures[i].get(), i * i);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn
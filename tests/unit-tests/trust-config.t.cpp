@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2017, Regents of the University of California.
+ *
+ * This file is part of ndnabac, a certificate management system based on NDN.
+ *
+ * ndnabac is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * ndnabac is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License along with
+ * ndnabac, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndnabac authors and contributors.
+ */
+
+#include "trust-config.hpp"
+
+#include "test-common.hpp"
+
+namespace ndn {
+namespace ndnabac {
+namespace tests {
+
+BOOST_FIXTURE_TEST_SUITE(TestTrustConfig, IdentityManagementFixture)
+
+BOOST_AUTO_TEST_CASE(Lookup)
+{
+  auto identityA = addIdentity("/a");
+  auto certA1 = identityA.getDefaultKey().getDefaultCertificate();
+  auto certA2 = m_keyChain.createKey(identityA).getDefaultCertificate();
+  auto certB = addIdentity("/b").getDefaultKey().getDefaultCertificate();
+
+  TrustConfig config;
+  config.addCertificate(certA1);
+  config.addCertificate(certA2);
+  config.addCertificate(certB);
+  config.addCertificate(certB);
+  BOOST_CHECK_EQUAL(config.size(), 3);
+
+  BOOST_REQUIRE(config.findByKeyName(certB.getKeyName()) != nullptr);
+  BOOST_CHECK_EQUAL(config.findByKeyName(certB.getKeyName())->getName(), certB.getName());
+  BOOST_REQUIRE(config.findByIdentity("/b") != nullptr);
+  BOOST_CHECK_EQUAL(config.findByIdentity("/b")->getName(), certB.getName());
+  BOOST_REQUIRE(config.findByIdentity("/a") != nullptr);
+  BOOST_CHECK_EQUAL(config.findByIdentity("/a")->getIdentity(), Name("/a"));
+  BOOST_CHECK(config.findByIdentity("/c") == nullptr);
+
+  // the identity stays known as long as one of its keys is
+  BOOST_CHECK(config.removeCertificate(certA1.getKeyName()));
+  BOOST_CHECK(!config.removeCertificate(certA1.getKeyName()));
+  BOOST_CHECK(config.findByKeyName(certA1.getKeyName()) == nullptr);
+  BOOST_REQUIRE(config.findByIdentity("/a") != nullptr);
+  BOOST_CHECK_EQUAL(config.findByIdentity("/a")->getName(), certA2.getName());
+  BOOST_CHECK(config.removeCertificate(certA2.getKeyName()));
+  BOOST_CHECK(config.findByIdentity("/a") == nullptr);
+  BOOST_CHECK_EQUAL(config.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FindBySigner)
+{
+  auto identityA = addIdentity("/a");
+  auto certA1 = identityA.getDefaultKey().getDefaultCertificate();
+  auto certA2 = m_keyChain.createKey(identityA).getDefaultCertificate();
+
+  TrustConfig config;
+  config.addCertificate(certA1);
+  config.addCertificate(certA2);
+
+  // each key of an identity gets its own anchor
+  for (const auto& cert : {certA1, certA2}) {
+    Interest interest(Name("/aa/DKEY").append(Name("/a").wireEncode()));
+    m_keyChain.sign(interest, security::signingByCertificate(cert));
+    BOOST_REQUIRE(config.findBySigner(interest) != nullptr);
+    BOOST_CHECK_EQUAL(config.findBySigner(interest)->getName(), cert.getName());
+  }
+
+  BOOST_CHECK(config.findBySigner(Interest("/aa/DKEY")) == nullptr);
+  Interest unknown("/aa/DKEY");
+  auto certB = addIdentity("/b").getDefaultKey().getDefaultCertificate();
+  m_keyChain.sign(unknown, security::signingByCertificate(certB));
+  BOOST_CHECK(config.findBySigner(unknown) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ndnabac
+} // namespace ndn